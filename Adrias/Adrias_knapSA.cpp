@@ -6,10 +6,35 @@
 #include <limits.h> // INT_MAX
 #include <float.h> //DBL_MAX
 #include <time.h> 
-#include <vector>   // armazenamento/ordenação de itens
-#include <random>   // números aleatórios (tweak/SA)
 #include <cmath>    // exp() para aceitação no SA
 #include <chrono>   // medição de tempo
+#include <vector>   // lista de instâncias (modo lote)
+#include <string>
+#include <filesystem> // varredura de diretórios (modo lote)
+#include <map>
+#include <unordered_set>
+#include <stdarg.h> // linha CSV montada por csvf
+#include <atomic>   // cadeias paralelas (--chains)
+#include <mutex>
+#include <thread>
+#include "../common/itemStore.h" // colunas contíguas profit/weight/order
+#include "../common/solution.h"  // solução em bits (uint64_t)
+#include "../common/greedy.h" // gulosa por item crítico
+#include "../common/localSearch.h" // trocas 1-1 + preenchimento antes do SA (--start ls)
+#include "../common/reduction.h" // núcleo reduzido para o SA (--reduce)
+#include "../common/instanceReader.h" // leitura via mmap
+#include "../common/exactDP.h" // modo exato (--exact dp)
+#include "../common/branchBound.h" // modo exato (--exact bb)
+#include "../common/workPool.h" // resolveThreadCount (--chains)
+#include "../common/random.h" // xoshiro256++ (tweak/SA)
+#include "../common/acceptance.h" // limiares de Metropolis pré-calculados
+#include "../common/calibration.h" // T0/Tf a partir de pioras amostradas
+#include "../common/optima.h" // ótimos conhecidos (--optima) e resumo de qualidade
+#include "../common/instrument.h" // contadores do SA (-DKNAPSA_INSTRUMENT)
+#include "../common/resultCache.h" // resultados já calculados (--cache)
+#include "../common/journal.h" // diário da varredura (--journal, --resume, --merge)
+#include "../common/cancel.h" // prazo por instância (--instance-timeout-ms)
+#include "../common/tuneProfile.h" // parâmetros do SA por classe (--profile, tools/knapTune)
 //n_400_c_1000000_g_14_f_0.1_eps_0_s_100
 //n - number of itens
 //c - capacity
@@ -18,227 +43,1369 @@
 //eps - influences in the calculation of profit and weight
 //s - numbers sampled between 1 and s
 
-long long calculateSolProfit(const bool *sol);//calculate the profit of a given solution - invalid solutions get -1
-double calculatePenalizedScore(const bool *sol, double penaltyCoef);
-void tweak(bool* sol, int &idx1, int &idx2, bool &twoFlips);
-void readFile(const char* fileName);
+long long calculateSolProfit(const Solution &sol);//calculate the profit of a given solution - invalid solutions get -1
+double calculatePenalizedScore(const Solution &sol, double penaltyCoef);
+void tweak(Rng &rng, int &idx1, int &idx2, bool &twoFlips); // sorteia o movimento sem alterar a solução
+bool readFile(const char* fileName); // false se o arquivo não puder ser lido/for inválido
+// Opções de linha de comando repassadas a cada instância
+enum ExactMode { EXACT_NONE = 0, EXACT_DP, EXACT_BB };
+// Solução inicial do SA: zerada (original), gulosa, ou gulosa melhorada por busca local
+enum StartMode { START_ZERO, START_GREEDY, START_LOCAL };
 
-// itens[i] = {lucro, peso}; size = número de itens; maxWeight = capacidade
-long long **itens; int size=-1; long long maxWeight=-1; //[profit, weight]
+struct RunOptions {
+	unsigned int seed = 42;            // padrão reprodutível
+	long double penaltyFactor = 10.0L; // fator ajustável da penalidade
+	ExactMode exact = EXACT_NONE;      // --exact dp: troca o SA pela DP; --exact bb: B&B depois do SA
+	DPOptions dp;                      // --reconstruct, --dp-max-mb
+	BBOptions bb;                      // --bb-nodes, --bb-time-ms
+	int chains = 1;                    // --chains K: cadeias de SA em paralelo (0 = todos os núcleos)
+	int exchangeEvery = 10;            // --exchange N: troca de soluções a cada N temperaturas (0 = nunca)
+	bool exactAccept = false;          // --accept exact: std::log por teste (validação do modo em bloco)
+	long long timeLimitMs = 0;         // --time-limit-ms: orçamento de tempo do SA por cadeia (0 = sem)
+	long long maxEvals = 0;            // --max-evals: orçamento de movimentos avaliados por cadeia (0 = sem)
+	bool autoTemp = true;              // --temp auto: T0/Tf calibradas e patamar adaptativo; fixed: 10000/0.1 e size/2
+	StartMode start = START_LOCAL;     // --start zero|greedy|ls: solução inicial das cadeias
+	int lsRounds = 0;                  // --ls-rounds N: trocas da busca local (0 = até o ótimo local)
+	double initialAcceptance = -1.0;   // --init-accept: aceitação inicial na calibração (<0: 0.8 a frio, 0.3 com --start greedy|ls)
+	double finalAcceptance = 0.001;    // --final-accept: aceitação final na calibração
+	double levelFactor = 0.5;          // --level-factor: tentativas por patamar = fator * n (mínimo 10)
+	double alpha = 0.99;               // --alpha: resfriamento geométrico (sem orçamento)
+	bool reduce = true;                // --reduce on|off: SA sobre o núcleo após fixação e dominância
+	long long instanceTimeoutMs = 0;   // --instance-timeout-ms: prazo de cada instância (0 = sem); não entra na chave
+	bool portfolio = false;            // --portfolio: SA, B&B e DP em corrida (threads) após a gulosa
+	long long portfolioMs = 0;         // --portfolio-ms: prazo da corrida (0 = cada método com seu próprio limite)
+};
+
+// Aceitação inicial de pioras quando o SA parte de uma solução boa (--start greedy|ls):
+// reaquece o bastante para sair do ótimo local sem gastar os primeiros patamares
+// desfazendo a solução inicial, como acontece com os 80% do início a frio.
+// --init-accept (ou o perfil da classe) substitui este valor e o do início a frio.
+const double WARM_INITIAL_ACCEPTANCE = 0.3;
+
+// --trace: arquivo da trajetória anytime (melhor lucro ao longo do tempo)
+static FILE *traceFile = NULL;
+
+// --optima: ótimos conhecidos, carregados uma vez; com eles cada linha ganha as colunas
+// de qualidade e o resumo por classe/algoritmo é emitido ao final (--summary ou stderr)
+static OptimaTable optima;
+static bool optimaLoaded = false;
+static bool stopAtOptimum = false; // --stop-at-optimum: SA para ao atingir o ótimo conhecido
+static QualitySummary quality;
+static FILE *summaryFile = NULL;
+void reportQuality(const char* label, long long optimum, long long greedyProfit, long long greedyMs,
+                   const char* algorithm, long long profit, double bestMs, double totalMs);
+int finishRun(int code); // emite o resumo de qualidade e devolve code
+
+// --stats (só com -DKNAPSA_INSTRUMENT): contadores e tempos de cada instância em JSON
+static FILE *statsFile = NULL;
+KNAPSA_STAT(static int statsRows = 0;)
+void reportInstrumentation(const char* label, int nChains);
+
+// --cache: resultados por (instância, versão, algoritmo, parâmetros, semente); uma
+// instância já resolvida com a mesma chave é impressa do cache sem rodar o solver.
+// SOLVER_VERSION muda sempre que uma alteração no código muda os resultados, o que
+// descarta as entradas antigas na abertura do cache.
+const uint32_t SOLVER_VERSION = 23;
+static ResultCache resultCache;
+uint64_t parameterHash(const RunOptions &opts); // opções que afetam o resultado, sem a semente
+// Estado da linha exata (RunRecord.status); no SA fica RESULT_HEURISTIC
+enum ResultStatus { RESULT_HEURISTIC = 0, RESULT_OPTIMAL, RESULT_LIMIT, RESULT_DEADLINE };
+const int ALGORITHM_PORTFOLIO = 3; // RunRecord.algorithm: além dos valores de ExactMode
+void printResult(const char* label, const RunOptions &opts, const RunRecord &rec, long long optimum);
+// Linha CSV da instância, montada por csvf e impressa (e gravada no diário) de uma vez
+static std::string csvLine;
+void csvf(const char *fmt, ...);
+
+// --journal: diário das instâncias concluídas (common/journal.h). Com --resume as que já
+// têm registro ok na mesma configuração (runConfig) são puladas sem ler o arquivo.
+static Journal journal;
+static std::string runConfig; // versão + parâmetros + semente, em hexadecimal
+static std::unordered_set<std::string> completed; // rótulos com registro ok (--resume)
+std::string configKey(const RunOptions &opts);
+bool alreadyDone(const char* label); // --resume: pula a instância
+
+// --profile: parâmetros do SA por classe de instância (common/tuneProfile.h, gerado pelo
+// tools/knapTune); as classes fora do perfil usam as opções da linha de comando
+static ParamProfile profile;
+static bool profileLoaded = false;
+const RunOptions &profiledOptions(const char* label, const RunOptions &opts);
+SAParams paramsOf(const RunOptions &opts);
+void applyParams(const SAParams &p, RunOptions &opts);
+void recordFailure(const char* label, const char* status, const char* reason);
+int mergeJournals(int count, const char **paths); // --merge: CSV final a partir dos diários
+
+// --instance-timeout-ms: prazo de cada instância; SA, DP e B&B param no próximo ponto de
+// verificação e a instância é registrada como timeout (sem linha CSV nem cache)
+static CancelToken instanceCancel;
+bool runLoadedInstance(const char* label, const RunOptions &opts); // desfecho no diário
+
+// --portfolio: depois da gulosa, SA (nesta thread), B&B e DP correm juntos. O lucro da
+// melhor solução de cada um vai para raceBound (o B&B poda com ele), e uma prova de
+// otimalidade (DP ou B&B completos) ou o prazo cancelam todos (raceCancel). O SA consulta
+// saCancel: instanceCancel fora da corrida, raceCancel durante ela.
+enum Engine { ENGINE_GREEDY = 0, ENGINE_SA, ENGINE_BB, ENGINE_DP, ENGINE_COUNT };
+static const char *ENGINE_NAMES[ENGINE_COUNT] = {"guloso", "sa", "bb", "dp"};
+static CancelToken raceCancel;
+static CancelToken *saCancel = &instanceCancel;
+static SharedBound *raceBound = nullptr;
+RunRecord solvePortfolio(const char* label, const RunOptions &opts, const Solution &greedy, long long greedyProfit,
+                         double greedyAtMs, long long stopAt, std::chrono::steady_clock::time_point start, const Solution *&result);
+
+bool solveInstance(const char* fileName, const RunOptions &opts);
+bool solveLoadedInstance(const char* label, const RunOptions &opts); // itens/maxWeight já carregados; false = prazo esgotado
+RunRecord solveExact(const char* label, const RunOptions &opts, const Solution &incumbent, long long incumbentProfit,
+                     long long heuristicMs);
+int solveArchive(const char* fileName, const RunOptions &opts);
+void collectInstances(const char* dir, std::vector<std::string> &paths);
+void readManifest(FILE *stream, std::vector<std::string> &paths);
+
+// itens.profit[i]/itens.weight[i] = lucro/peso; size = número de itens; maxWeight = capacidade
+// (reaproveitados entre instâncias no modo lote)
+ItemStore itens; int size=-1; long long maxWeight=-1;
+
+// Soluções reaproveitadas entre instâncias (resize mantém a memória já alocada)
+struct Workspace { Solution greedySol, startSol, coreStart, saSol, exactSol, dpSol, cachedSol; };
+static Workspace work;
 
-// RNG global para reprodutibilidade
-static std::mt19937 rng;
+// Cadeia de SA: estado próprio (RNG e soluções); itens/size/maxWeight são só lidos
+struct TracePoint { long long elapsedUs, evals, bestProfit; };
+struct SAChain {
+	Rng rng;
+	MetropolisThresholds metropolis; // ln(u) em bloco (ou std::log com --accept exact)
+	Solution currentSol, bestSol;
+	long long bestProfit = 0;
+	std::vector<TracePoint> trace; // melhorias da melhor solução (só com --trace)
+	TemperatureSchedule schedule;  // T0/Tf calibradas (inválida = valores fixos)
+	long long stopAt = -1;         // --stop-at-optimum: lucro que encerra a cadeia (-1 = nunca)
+	std::chrono::steady_clock::time_point bestAt; // quando bestProfit foi atingido (tempo até a melhor)
+	KNAPSA_STAT(SAStats stats;) // contadores da cadeia (-DKNAPSA_INSTRUMENT)
+};
+static std::vector<SAChain> chains; // cadeias reaproveitadas entre instâncias
+TemperatureSchedule calibrateTemperatures(const Solution &anchor, double penaltyCoef, unsigned int seed, const TemperatureTargets &targets);
 
+// Melhor solução viável compartilhada entre as cadeias (--chains K).
+// O lucro é atômico: as cadeias comparam sem travar e só entram na seção crítica
+// (cópia das palavras da solução) quando têm algo melhor a publicar ou a adotar.
+struct BestSlot {
+	std::atomic<long long> profit{-1};
+	std::mutex m;
+	Solution sol;
+
+	void publish(const Solution &s, long long p){
+		if(p <= profit.load(std::memory_order_relaxed)) return;
+		std::lock_guard<std::mutex> lk(m);
+		if(p <= profit.load(std::memory_order_relaxed)) return;
+		sol.copyFrom(s);
+		profit.store(p, std::memory_order_release);
+	}
+	// Copia a solução compartilhada em dst se ela for melhor que mine
+	bool adopt(Solution &dst, long long mine, long long &p){
+		if(profit.load(std::memory_order_acquire) <= mine) return false;
+		std::lock_guard<std::mutex> lk(m);
+		p = profit.load(std::memory_order_relaxed);
+		dst.copyFrom(sol);
+		return true;
+	}
+};
+void runChain(SAChain &chain, double penaltyCoef, BestSlot *slot, const RunOptions &opts);
+double penaltyCoefficient(long double penaltyFactor);
+long long greedySolution(Solution &sol); // sol zerada; devolve o lucro
+TemperatureSchedule startSchedule(const Solution &start, double penaltyCoef, const RunOptions &opts);
+SAChain &runAnnealing(const char* label, const Solution &start, const TemperatureSchedule &schedule, double penaltyCoef,
+                      const RunOptions &opts, long long stopAt = -1);
+const Solution &prepareStart(const Solution &greedy, const RunOptions &opts); // --start
+SAChain &annealFromStart(const char* label, const Solution &start, double penaltyCoef, const RunOptions &opts,
+                         long long stopAt, Solution &out, long long &outProfit); // --reduce
+
+// tools/knapBench.cpp inclui este arquivo com KNAPSA_NO_MAIN para medir as mesmas
+// rotinas (leitura, gulosa, SA) sem passar pela linha de comando
+#ifndef KNAPSA_NO_MAIN
 int main(const int argc, const char **inputFile){
-	char fileName[100]="";
-	
-	// Leitura do arquivo via argumento de linha de comando
+	// Uso: knapSA <instância | diretório | manifesto | -> [opções]
+	//  - arquivo .in: resolve uma instância (comportamento original)
+	//  - diretório: resolve todos os test.in abaixo dele, em ordem alfabética
+	//  - manifesto (com --batch): arquivo texto com um caminho de instância por linha
+	//  - "-": lê os caminhos da entrada padrão, um por linha
+	//  - arquivo compactado .knpa (tools/knapPack): resolve todas as instâncias dele
+	//  - "<arquivo.knpa>:<nome>": uma instância do arquivo compactado
+	//  - "--merge <diário>...": imprime o CSV final juntando diários (--journal)
+	if(argc >= 2 && strcmp(inputFile[1], "--merge") == 0)
+		return mergeJournals(argc - 2, inputFile + 2);
 	if(argc < 2){ // valida argumento obrigatório
-		fprintf(stderr,"use: knapSA <input file>\n\n");
+		fprintf(stderr,"use: knapSA <input file | directory | archive.knpa | manifest --batch | -> [--seed N] [--penalty F] [--chains K [--exchange N]] [--accept batch|exact]\n"
+		               "            [--time-limit-ms T] [--max-evals E] [--trace file.csv] [--temp auto|fixed] [--start zero|greedy|ls [--ls-rounds N]] [--reduce on|off]\n"
+		               "            [--init-accept A] [--final-accept A] [--level-factor F] [--alpha A] [--profile file.csv]\n"
+		               "            [--optima optima.csv [--stop-at-optimum] [--summary file.csv]] [--stats file.json] [--cache file.knpc [--cache-invalidate]]\n"
+		               "            [--journal file [--resume] [--journal-sync N]] [--instance-timeout-ms T] [--portfolio [--portfolio-ms T]]\n"
+		               "            [--exact dp [--reconstruct] [--dp-max-mb M]] [--exact bb [--bb-nodes N] [--bb-time-ms T]]\n"
+		               "       knapSA --merge <journal>...\n\n");
 		exit(1);
-	}else{
-		strcpy(fileName,inputFile[1]); // caminho da instância
 	}
+	const char* target = inputFile[1];
 
 	// Parâmetros opcionais
-	unsigned int seed = 42; // padrão reprodutível
-	long double penaltyFactor = 10.0L; // fator ajustável da penalidade
+	RunOptions opts;
+	bool forceBatch = false; // trata o alvo como manifesto
+	const char *cachePath = NULL;
+	bool cacheInvalidate = false;
+	const char *journalPath = NULL;
+	bool resume = false;
 	for(int ai = 2; ai < argc; ++ai){
 		const char* arg = inputFile[ai];
 		if(strcmp(arg, "--seed") == 0 || strcmp(arg, "-s") == 0){
-			if(ai+1 < argc){ seed = (unsigned int)strtoul(inputFile[++ai], nullptr, 10); }
-		}else if(strncmp(arg, "--seed=", 8) == 0){
-			seed = (unsigned int)strtoul(arg+8, nullptr, 10);
+			if(ai+1 < argc){ opts.seed = (unsigned int)strtoul(inputFile[++ai], nullptr, 10); }
+		}else if(strncmp(arg, "--seed=", 7) == 0){
+			opts.seed = (unsigned int)strtoul(arg+7, nullptr, 10);
 		}else if(strcmp(arg, "--penalty") == 0 || strcmp(arg, "-p") == 0){
-			if(ai+1 < argc){ penaltyFactor = strtold(inputFile[++ai], nullptr); }
+			if(ai+1 < argc){ opts.penaltyFactor = strtold(inputFile[++ai], nullptr); }
 		}else if(strncmp(arg, "--penalty=", 10) == 0){
-			penaltyFactor = strtold(arg+10, nullptr);
+			opts.penaltyFactor = strtold(arg+10, nullptr);
+		}else if(strcmp(arg, "--exact") == 0 || strncmp(arg, "--exact=", 8) == 0){
+			const char *mode = (arg[7] == '=') ? arg+8 : (ai+1 < argc ? inputFile[++ai] : "");
+			if(strcmp(mode, "dp") == 0) opts.exact = EXACT_DP;
+			else if(strcmp(mode, "bb") == 0) opts.exact = EXACT_BB;
+			else{
+				fprintf(stderr,"unknown exact mode: %s (use: dp | bb)\n", mode);
+				exit(1);
+			}
+		}else if(strcmp(arg, "--reconstruct") == 0){
+			opts.dp.reconstruct = true;
+		}else if(strcmp(arg, "--dp-max-mb") == 0 || strncmp(arg, "--dp-max-mb=", 12) == 0){
+			const char *val = (arg[11] == '=') ? arg+12 : (ai+1 < argc ? inputFile[++ai] : "0");
+			opts.dp.maxBytes = static_cast<size_t>(strtoull(val, nullptr, 10)) << 20;
+		}else if(strcmp(arg, "--chains") == 0 || strncmp(arg, "--chains=", 9) == 0){
+			const char *val = (arg[8] == '=') ? arg+9 : (ai+1 < argc ? inputFile[++ai] : "1");
+			opts.chains = atoi(val);
+		}else if(strcmp(arg, "--exchange") == 0 || strncmp(arg, "--exchange=", 11) == 0){
+			const char *val = (arg[10] == '=') ? arg+11 : (ai+1 < argc ? inputFile[++ai] : "0");
+			opts.exchangeEvery = atoi(val);
+		}else if(strcmp(arg, "--accept") == 0 || strncmp(arg, "--accept=", 9) == 0){
+			const char *mode = (arg[8] == '=') ? arg+9 : (ai+1 < argc ? inputFile[++ai] : "");
+			if(strcmp(mode, "exact") == 0) opts.exactAccept = true;
+			else if(strcmp(mode, "batch") == 0) opts.exactAccept = false;
+			else{
+				fprintf(stderr,"unknown accept mode: %s (use: batch | exact)\n", mode);
+				exit(1);
+			}
+		}else if(strcmp(arg, "--temp") == 0 || strncmp(arg, "--temp=", 7) == 0){
+			const char *mode = (arg[6] == '=') ? arg+7 : (ai+1 < argc ? inputFile[++ai] : "");
+			if(strcmp(mode, "auto") == 0) opts.autoTemp = true;
+			else if(strcmp(mode, "fixed") == 0) opts.autoTemp = false;
+			else{
+				fprintf(stderr,"unknown temperature mode: %s (use: auto | fixed)\n", mode);
+				exit(1);
+			}
+		}else if(strcmp(arg, "--start") == 0 || strncmp(arg, "--start=", 8) == 0){
+			const char *mode = (arg[7] == '=') ? arg+8 : (ai+1 < argc ? inputFile[++ai] : "");
+			if(strcmp(mode, "zero") == 0) opts.start = START_ZERO;
+			else if(strcmp(mode, "greedy") == 0) opts.start = START_GREEDY;
+			else if(strcmp(mode, "ls") == 0) opts.start = START_LOCAL;
+			else{
+				fprintf(stderr,"unknown start mode: %s (use: zero | greedy | ls)\n", mode);
+				exit(1);
+			}
+		}else if(strcmp(arg, "--ls-rounds") == 0 || strncmp(arg, "--ls-rounds=", 12) == 0){
+			const char *val = (arg[11] == '=') ? arg+12 : (ai+1 < argc ? inputFile[++ai] : "0");
+			opts.lsRounds = atoi(val);
+		}else if(strcmp(arg, "--init-accept") == 0 || strncmp(arg, "--init-accept=", 14) == 0){
+			const char *val = (arg[13] == '=') ? arg+14 : (ai+1 < argc ? inputFile[++ai] : "-1");
+			opts.initialAcceptance = strtod(val, nullptr);
+		}else if(strcmp(arg, "--final-accept") == 0 || strncmp(arg, "--final-accept=", 15) == 0){
+			const char *val = (arg[14] == '=') ? arg+15 : (ai+1 < argc ? inputFile[++ai] : "0");
+			opts.finalAcceptance = strtod(val, nullptr);
+		}else if(strcmp(arg, "--level-factor") == 0 || strncmp(arg, "--level-factor=", 15) == 0){
+			const char *val = (arg[14] == '=') ? arg+15 : (ai+1 < argc ? inputFile[++ai] : "0");
+			opts.levelFactor = strtod(val, nullptr);
+		}else if(strcmp(arg, "--alpha") == 0 || strncmp(arg, "--alpha=", 8) == 0){
+			const char *val = (arg[7] == '=') ? arg+8 : (ai+1 < argc ? inputFile[++ai] : "0");
+			opts.alpha = strtod(val, nullptr);
+		}else if(strcmp(arg, "--profile") == 0 || strncmp(arg, "--profile=", 10) == 0){
+			const char *path = (arg[9] == '=') ? arg+10 : (ai+1 < argc ? inputFile[++ai] : "");
+			int status = profile.load(path);
+			if(status < 0){
+				fprintf(stderr,"\nFail to Open File!! (%s)\n", path);
+				exit(1);
+			}
+			if(status > 0){
+				fprintf(stderr,"invalid profile %s (line %d)\n", path, status);
+				exit(1);
+			}
+			profileLoaded = true;
+		}else if(strcmp(arg, "--reduce") == 0 || strncmp(arg, "--reduce=", 9) == 0){
+			const char *mode = (arg[8] == '=') ? arg+9 : (ai+1 < argc ? inputFile[++ai] : "");
+			if(strcmp(mode, "on") == 0) opts.reduce = true;
+			else if(strcmp(mode, "off") == 0) opts.reduce = false;
+			else{
+				fprintf(stderr,"unknown reduce mode: %s (use: on | off)\n", mode);
+				exit(1);
+			}
+		}else if(strcmp(arg, "--time-limit-ms") == 0 || strncmp(arg, "--time-limit-ms=", 16) == 0){
+			const char *val = (arg[15] == '=') ? arg+16 : (ai+1 < argc ? inputFile[++ai] : "0");
+			opts.timeLimitMs = strtoll(val, nullptr, 10);
+		}else if(strcmp(arg, "--max-evals") == 0 || strncmp(arg, "--max-evals=", 12) == 0){
+			const char *val = (arg[11] == '=') ? arg+12 : (ai+1 < argc ? inputFile[++ai] : "0");
+			opts.maxEvals = strtoll(val, nullptr, 10);
+		}else if(strcmp(arg, "--trace") == 0 || strncmp(arg, "--trace=", 8) == 0){
+			const char *path = (arg[7] == '=') ? arg+8 : (ai+1 < argc ? inputFile[++ai] : "");
+			traceFile = fopen(path, "w");
+			if(traceFile == NULL){
+				fprintf(stderr,"\nFail to Open File!! (%s)\n", path);
+				exit(1);
+			}
+			fprintf(traceFile, "instancia,cadeia,tempo_us,avaliacoes,melhor_lucro\n");
+		}else if(strcmp(arg, "--optima") == 0 || strncmp(arg, "--optima=", 9) == 0){
+			const char *path = (arg[8] == '=') ? arg+9 : (ai+1 < argc ? inputFile[++ai] : "");
+			if(!optima.load(path)){
+				fprintf(stderr,"\nFail to Open File!! (%s)\n", path);
+				exit(1);
+			}
+			optimaLoaded = true;
+		}else if(strcmp(arg, "--stop-at-optimum") == 0){
+			stopAtOptimum = true;
+		}else if(strcmp(arg, "--summary") == 0 || strncmp(arg, "--summary=", 10) == 0){
+			const char *path = (arg[9] == '=') ? arg+10 : (ai+1 < argc ? inputFile[++ai] : "");
+			summaryFile = fopen(path, "w");
+			if(summaryFile == NULL){
+				fprintf(stderr,"\nFail to Open File!! (%s)\n", path);
+				exit(1);
+			}
+		}else if(strcmp(arg, "--stats") == 0 || strncmp(arg, "--stats=", 8) == 0){
+			const char *path = (arg[7] == '=') ? arg+8 : (ai+1 < argc ? inputFile[++ai] : "");
+#ifdef KNAPSA_INSTRUMENT
+			statsFile = fopen(path, "w");
+			if(statsFile == NULL){
+				fprintf(stderr,"\nFail to Open File!! (%s)\n", path);
+				exit(1);
+			}
+			fprintf(statsFile, "[");
+#else
+			fprintf(stderr,"--stats %s requires a build with -DKNAPSA_INSTRUMENT\n", path);
+			exit(1);
+#endif
+		}else if(strcmp(arg, "--cache") == 0 || strncmp(arg, "--cache=", 8) == 0){
+			cachePath = (arg[7] == '=') ? arg+8 : (ai+1 < argc ? inputFile[++ai] : "");
+#ifdef KNAPSA_INSTRUMENT
+			fprintf(stderr,"--cache %s is not available in a build with -DKNAPSA_INSTRUMENT\n", cachePath);
+			exit(1);
+#endif
+		}else if(strcmp(arg, "--cache-invalidate") == 0){
+			cacheInvalidate = true;
+		}else if(strcmp(arg, "--journal") == 0 || strncmp(arg, "--journal=", 10) == 0){
+			journalPath = (arg[9] == '=') ? arg+10 : (ai+1 < argc ? inputFile[++ai] : "");
+		}else if(strcmp(arg, "--resume") == 0){
+			resume = true;
+		}else if(strcmp(arg, "--journal-sync") == 0 || strncmp(arg, "--journal-sync=", 15) == 0){
+			const char *val = (arg[14] == '=') ? arg+15 : (ai+1 < argc ? inputFile[++ai] : "1");
+			journal.syncEvery = std::max(1, atoi(val));
+		}else if(strcmp(arg, "--portfolio") == 0){
+			opts.portfolio = true;
+		}else if(strcmp(arg, "--portfolio-ms") == 0 || strncmp(arg, "--portfolio-ms=", 15) == 0){
+			const char *val = (arg[14] == '=') ? arg+15 : (ai+1 < argc ? inputFile[++ai] : "0");
+			opts.portfolioMs = strtoll(val, nullptr, 10);
+		}else if(strcmp(arg, "--instance-timeout-ms") == 0 || strncmp(arg, "--instance-timeout-ms=", 22) == 0){
+			const char *val = (arg[21] == '=') ? arg+22 : (ai+1 < argc ? inputFile[++ai] : "0");
+			opts.instanceTimeoutMs = strtoll(val, nullptr, 10);
+		}else if(strcmp(arg, "--bb-nodes") == 0 || strncmp(arg, "--bb-nodes=", 11) == 0){
+			const char *val = (arg[10] == '=') ? arg+11 : (ai+1 < argc ? inputFile[++ai] : "0");
+			opts.bb.maxNodes = strtoll(val, nullptr, 10);
+		}else if(strcmp(arg, "--bb-time-ms") == 0 || strncmp(arg, "--bb-time-ms=", 13) == 0){
+			const char *val = (arg[12] == '=') ? arg+13 : (ai+1 < argc ? inputFile[++ai] : "0");
+			opts.bb.timeLimitMs = strtoll(val, nullptr, 10);
+		}else if(strcmp(arg, "--batch") == 0 || strcmp(arg, "-b") == 0){
+			forceBatch = true;
 		}
 	}
-	rng.seed(seed);
 
-	readFile(fileName);
+	std::error_code ec;
+	bool isDir = std::filesystem::is_directory(target, ec);
+	bool isStdin = (strcmp(target, "-") == 0);
+	if(stopAtOptimum && !optimaLoaded){
+		fprintf(stderr,"--stop-at-optimum requires --optima\n");
+		exit(1);
+	}
+	{ // faixas dos parâmetros do SA (as mesmas exigidas de um perfil)
+		SAParams p = paramsOf(opts);
+		if(!p.valid()){
+			fprintf(stderr,"invalid SA parameters (need penalty > 0, 0 < final-accept < init-accept < 1, level-factor > 0, 0 < alpha < 1)\n");
+			exit(1);
+		}
+	}
+	if(cacheInvalidate && cachePath == NULL){
+		fprintf(stderr,"--cache-invalidate requires --cache\n");
+		exit(1);
+	}
+	std::vector<uint64_t> invalidParams; // --cache-invalidate: as opções dadas e, com --profile, as de cada classe
+	if(cacheInvalidate){
+		invalidParams.push_back(parameterHash(opts));
+		for(const auto &kv : profile.byClass){
+			RunOptions tuned = opts;
+			applyParams(kv.second.params, tuned);
+			invalidParams.push_back(parameterHash(tuned));
+		}
+	}
+	if(cachePath != NULL && !resultCache.open(cachePath, SOLVER_VERSION, invalidParams)){
+		fprintf(stderr,"\nFail to Open File!! (%s)\n", cachePath);
+		exit(1);
+	}
+	if(opts.portfolio && opts.exact != EXACT_NONE){
+		fprintf(stderr,"--portfolio already runs dp and bb; drop --exact\n");
+		exit(1);
+	}
+	if(resume && journalPath == NULL){
+		fprintf(stderr,"--resume requires --journal\n");
+		exit(1);
+	}
+	if(journalPath != NULL){
+		std::vector<JournalEntry> entries;
+		if(!journal.open(journalPath, &entries)){
+			fprintf(stderr,"\nFail to Open File!! (%s)\n", journalPath);
+			exit(1);
+		}
+		runConfig = configKey(opts);
+		if(resume){
+			for(const JournalEntry &e : entries)
+				if(e.status == "ok" && e.config == runConfig) completed.insert(e.label);
+			fprintf(stderr,"resume %s: %zu instances already done\n", journalPath, completed.size());
+		}
+	}
+	opts.dp.cancel = opts.bb.cancel = &instanceCancel;
+	if(!isDir && !isStdin && isInstanceArchive(target)) // lote sobre o arquivo compactado
+		return finishRun(solveArchive(target, opts));
+	if(!isDir && !isStdin && !forceBatch){ // uma instância: erro de leitura aborta, como antes
+		if(!solveInstance(target, opts))
+			exit(1);
+		return finishRun(0);
+	}
+
+	// Modo lote: um único processo resolve todas as instâncias, reaproveitando os
+	// buffers (ItemStore e soluções) e emitindo uma linha CSV por instância.
+	std::vector<std::string> paths;
+	if(isDir){
+		collectInstances(target, paths);
+	}else if(isStdin){
+		readManifest(stdin, paths);
+	}else{
+		FILE *manifest = fopen(target, "r");
+		if(manifest == NULL){
+			fprintf(stderr,"\nFail to Open File!! (%s)\n", target);
+			exit(1);
+		}
+		readManifest(manifest, paths);
+		fclose(manifest);
+	}
+
+	int failures = 0;
+	for(const std::string &path : paths){
+		if(!solveInstance(path.c_str(), opts)) // falha isolada (ou prazo esgotado) não interrompe o lote
+			++failures;
+		fflush(stdout); // uma linha por instância, visível assim que resolvida
+	}
+	return finishRun(failures == 0 ? 0 : 2);
+}
+#endif
+
+// Fecha --stats e o diário, emite o resumo de qualidade por classe/algoritmo (só com
+// --optima) e as contagens do cache (--cache)
+int finishRun(int code){
+	if(statsFile != NULL){
+		fprintf(statsFile, "\n]\n");
+		fclose(statsFile);
+	}
+	if(optimaLoaded){
+		quality.write(summaryFile != NULL ? summaryFile : stderr);
+		if(summaryFile != NULL) fclose(summaryFile);
+	}
+	if(resultCache.isOpen()){
+		fprintf(stderr,"cache %s: %lld hits, %lld misses, %lld stored\n", resultCache.path.c_str(),
+		        resultCache.hits, resultCache.misses, resultCache.stored);
+		resultCache.close();
+	}
+	journal.close(); // fsync dos registros pendentes
+	return code;
+}
+
+// Colunas de qualidade (--optima), acrescentadas à linha CSV da instância:
+// otimo,gap_otimo_pct,atingiu_otimo,tempo_ate_melhor_ms (gap e atingiu_otimo vazios se o
+// ótimo for desconhecido). Acumula gulosa e algoritmo no resumo por classe.
+void reportQuality(const char* label, long long optimum, long long greedyProfit, long long greedyMs,
+                   const char* algorithm, long long profit, double bestMs, double totalMs){
+	if(optimum >= 0)
+		csvf(",%lld,%.6f,%d,%.3f", optimum, gapPercent(optimum, profit), profit >= optimum ? 1 : 0, bestMs);
+	else
+		csvf(",-1,,,%.3f", bestMs);
+	std::string cls = instanceClass(instanceNameFromPath(label));
+	quality.add(cls, "guloso", optimum, greedyProfit, static_cast<double>(greedyMs));
+	quality.add(cls, algorithm, optimum, profit, totalMs);
+}
+
+#ifdef KNAPSA_INSTRUMENT
+// Colunas extras da linha CSV (build instrumentado), somando as cadeias:
+// movimentos,aceitos_pct,pioras_aceitas_pct,inviaveis_pct,melhorias,ultima_melhora_patamar,patamares,
+// parse_ns,ordenacao_ns,gulosa_ns,sa_ns (ultima_melhora_patamar/patamares da cadeia 0).
+// Com --stats grava também o detalhe por cadeia e por patamar em JSON.
+void reportInstrumentation(const char* label, int nChains){
+	LevelStats total;
+	uint64_t improvements = 0;
+	for(int k=0; k<nChains; ++k){
+		total.add(chains[k].stats.total);
+		improvements += chains[k].stats.improvements;
+	}
+	double moves = total.moves > 0 ? static_cast<double>(total.moves) : 1.0;
+	double nsCycle = nsPerCycle();
+	const PhaseTimes &ph = threadPhases();
+	csvf(",%llu,%.4f,%.4f,%.4f,%llu,%lld,%zu", (unsigned long long)total.moves, 100.0 * total.accepts / moves,
+	       100.0 * total.uphill / moves, 100.0 * total.infeasible / moves, (unsigned long long)improvements,
+	       chains[0].stats.lastImproveLevel, chains[0].stats.levels.size());
+	for(int p=0; p<PHASE_COUNT; ++p) csvf(",%.0f", ph.cycles[p] * nsCycle);
+	if(statsFile == NULL) return;
+
+	FILE *f = statsFile;
+	fprintf(f, "%s\n{\"instance\": \"%s\", \"phases_ns\": {", statsRows++ ? "," : "", label);
+	for(int p=0; p<PHASE_COUNT; ++p) fprintf(f, "%s\"%s\": %.0f", p ? ", " : "", phaseName(p), ph.cycles[p] * nsCycle);
+	fprintf(f, "}, \"chains\": [");
+	for(int k=0; k<nChains; ++k){
+		const SAStats &st = chains[k].stats;
+		fprintf(f, "%s\n  {\"chain\": %d, \"best_profit\": %lld, \"moves\": %llu, \"accepts\": %llu, \"uphill\": %llu, \"infeasible\": %llu, "
+		        "\"infeasible_accepted\": %llu, \"improvements\": %llu, \"last_improve_move\": %lld, \"last_improve_level\": %lld, \"sa_ns\": %.0f,\n"
+		        "   \"levels\": [\"temperature\", \"moves\", \"accepts\", \"uphill\", \"infeasible\", \"infeasible_accepted\", \"ns\"",
+		        k ? "," : "", k, chains[k].bestProfit, (unsigned long long)st.total.moves, (unsigned long long)st.total.accepts,
+		        (unsigned long long)st.total.uphill, (unsigned long long)st.total.infeasible, (unsigned long long)st.total.infeasibleAccepted,
+		        (unsigned long long)st.improvements, st.lastImproveMove, st.lastImproveLevel, st.total.cycles * nsCycle);
+		for(const LevelStats &lv : st.levels) // primeira linha: nomes das colunas
+			fprintf(f, ",\n    [%.6g, %llu, %llu, %llu, %llu, %llu, %.0f]", lv.temperature, (unsigned long long)lv.moves,
+			        (unsigned long long)lv.accepts, (unsigned long long)lv.uphill, (unsigned long long)lv.infeasible,
+			        (unsigned long long)lv.infeasibleAccepted, lv.cycles * nsCycle);
+		fprintf(f, "]}");
+	}
+	fprintf(f, "]}");
+	fflush(f);
+}
+#endif
+
+// Resolve uma instância (gulosa + SA) e imprime sua linha CSV.
+// Retorna false se o arquivo não puder ser lido ou a instância falhar/esgotar o prazo.
+bool solveInstance(const char* fileName, const RunOptions &opts){
+	if(alreadyDone(fileName)) return true;
+	KNAPSA_STAT(threadPhases().reset();)
+	if(!readFile(fileName)){
+		recordFailure(fileName, "fail", "unreadable instance");
+		return false;
+	}
+	return runLoadedInstance(fileName, opts);
+}
+
+// Resolve a instância carregada e registra o desfecho no diário: ok (com a linha CSV),
+// timeout (--instance-timeout-ms) ou fail (exceção, ex.: falta de memória). Nos dois
+// últimos casos a varredura segue para a próxima instância.
+bool runLoadedInstance(const char* label, const RunOptions &opts){
+	instanceCancel.arm(opts.instanceTimeoutMs);
+	try{
+		if(solveLoadedInstance(label, profiledOptions(label, opts))){
+			journal.append(runConfig, "ok", label, csvLine.c_str());
+			return true;
+		}
+		char reason[64];
+		snprintf(reason, sizeof(reason), "time limit %lld ms", opts.instanceTimeoutMs);
+		recordFailure(label, "timeout", reason);
+	}catch(const std::exception &e){
+		recordFailure(label, "fail", e.what());
+	}
+	return false;
+}
+
+// Instância que não gerou linha CSV: aviso em stderr e registro no diário
+void recordFailure(const char* label, const char* status, const char* reason){
+	fprintf(stderr,"skipping %s (%s: %s)\n", label, status, reason);
+	journal.append(runConfig, status, label, reason);
+}
+
+// Configuração da varredura no diário: mesma versão, parâmetros e semente
+std::string configKey(const RunOptions &opts){
+	Hash128 h;
+	h.add(static_cast<uint64_t>(SOLVER_VERSION));
+	h.add(parameterHash(opts));
+	h.add(static_cast<uint64_t>(opts.seed));
+	if(profileLoaded) h.add(profile.digest());
+	char hex[24];
+	snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)h.lo);
+	return hex;
+}
+
+bool alreadyDone(const char* label){
+	return !completed.empty() && completed.count(label) > 0;
+}
+
+// Opções da instância: as da linha de comando com os parâmetros do SA da classe dela
+// substituídos pelos do perfil, se houver (--profile)
+const RunOptions &profiledOptions(const char* label, const RunOptions &opts){
+	if(!profileLoaded) return opts;
+	const SAParams *p = profile.find(instanceClass(instanceNameFromPath(label)));
+	if(p == nullptr) return opts;
+	static RunOptions tuned;
+	tuned = opts;
+	applyParams(*p, tuned);
+	return tuned;
+}
+
+// Parâmetros ajustáveis das opções (aceitação inicial já resolvida pelo modo de partida)
+SAParams paramsOf(const RunOptions &opts){
+	SAParams p;
+	p.penaltyFactor = static_cast<double>(opts.penaltyFactor);
+	p.initialAcceptance = (opts.initialAcceptance >= 0.0) ? opts.initialAcceptance :
+	                      (opts.start != START_ZERO) ? WARM_INITIAL_ACCEPTANCE : TemperatureTargets().initialAcceptance;
+	p.finalAcceptance = opts.finalAcceptance;
+	p.levelFactor = opts.levelFactor;
+	p.alpha = opts.alpha;
+	p.start = static_cast<int>(opts.start);
+	return p;
+}
+
+void applyParams(const SAParams &p, RunOptions &opts){
+	opts.penaltyFactor = static_cast<long double>(p.penaltyFactor);
+	opts.initialAcceptance = p.initialAcceptance;
+	opts.finalAcceptance = p.finalAcceptance;
+	opts.levelFactor = p.levelFactor;
+	opts.alpha = p.alpha;
+	opts.start = static_cast<StartMode>(p.start);
+}
+
+// --merge: junta os diários e imprime uma linha CSV por (instância, configuração), em
+// ordem de rótulo (a ordem do modo lote). Vale o último registro ok; instâncias só com
+// fail/timeout ficam de fora e são listadas em stderr. Retorna 2 se faltar alguma.
+int mergeJournals(int count, const char **paths){
+	std::map<std::pair<std::string, std::string>, std::string> lines; // (rótulo, config) -> CSV
+	std::map<std::pair<std::string, std::string>, std::string> failed; // último motivo
+	std::unordered_set<std::string> configs;
+	for(int k=0; k<count; ++k){
+		std::vector<JournalEntry> entries;
+		if(!readJournal(paths[k], entries)){
+			fprintf(stderr,"\nFail to Open File!! (%s)\n", paths[k]);
+			return 1;
+		}
+		for(JournalEntry &e : entries){
+			auto key = std::make_pair(e.label, e.config);
+			if(e.status == "ok"){
+				lines[key] = std::move(e.payload);
+				failed.erase(key);
+				configs.insert(e.config);
+			}else if(!lines.count(key)){
+				failed[key] = e.status + ": " + e.payload;
+			}
+		}
+	}
+	for(const auto &kv : lines) printf("%s\n", kv.second.c_str());
+	for(const auto &kv : failed) fprintf(stderr,"missing %s (%s)\n", kv.first.first.c_str(), kv.second.c_str());
+	if(configs.size() > 1)
+		fprintf(stderr,"WARNING: journals mix %zu configurations (version/parameters/seed)\n", configs.size());
+	fprintf(stderr,"merged %zu results, %zu missing\n", lines.size(), failed.size());
+	return failed.empty() ? 0 : 2;
+}
 
-	// Coeficiente de penalização baseado na média lucro/peso dos itens
+// Resolve todas as instâncias de um arquivo compactado, na ordem do índice (alfabética).
+// O arquivo é mapeado uma única vez; cada linha CSV usa o rótulo "<arquivo>:<nome>".
+int solveArchive(const char* fileName, const RunOptions &opts){
+	InstanceArchive archive;
+	if(!archive.open(fileName)){
+		fprintf(stderr,"\nERROR! Invalid instance archive, aborting!! (%s)\n", fileName);
+		exit(1);
+	}
+	int failures = 0;
+	std::string label;
+	for(int i=0; i<archive.count(); ++i){
+		label.assign(fileName).append(":").append(archive.name(i));
+		if(alreadyDone(label.c_str())) continue;
+		KNAPSA_STAT(threadPhases().reset();)
+		LoadStatus status;
+		{
+			KNAPSA_PHASE(PHASE_PARSE);
+			status = archive.load(i, itens, maxWeight);
+		}
+		if(status != LOAD_OK){
+			recordFailure(label.c_str(), "fail", "invalid archive entry");
+			++failures;
+			continue;
+		}
+		size = itens.n;
+		if(!runLoadedInstance(label.c_str(), opts)) ++failures;
+		fflush(stdout);
+	}
+	return failures == 0 ? 0 : 2;
+}
+
+// Coeficiente de penalização baseado na média lucro/peso dos itens
+double penaltyCoefficient(long double penaltyFactor){
 	long double totalProfit = 0.0L, totalWeight = 0.0L;
 	for(int i=0; i<size; ++i){
-		totalProfit += static_cast<long double>(itens[i][0]);
-		totalWeight += static_cast<long double>(itens[i][1]);
+		totalProfit += static_cast<long double>(itens.profit[i]);
+		totalWeight += static_cast<long double>(itens.weight[i]);
 	}
 	long double avgProfitPerWeight = (totalWeight > 0.0L) ? (totalProfit / totalWeight) : 1.0L;
-	double penaltyCoef = static_cast<double>(avgProfitPerWeight * penaltyFactor);
+	return static_cast<double>(avgProfitPerWeight * penaltyFactor);
+}
+
+// Heurística gulosa por razão lucro/peso decrescente (ver common/greedy.h: item
+// crítico por seleção e só a cauda que ainda cabe é ordenada). sol deve chegar
+// zerada; devolve o lucro.
+static GreedyScratch greedyScratch;
+long long greedySolution(Solution &sol){
+	return greedySolve(itens, maxWeight, sol, greedyScratch).profit;
+}
 
-	bool sol[size];
-	for(int i=0; i<size; i++)
-		sol[i]=false;
+// Solução inicial das cadeias (--start): com ls, a gulosa melhorada por trocas 1-1 e
+// preenchimento (common/localSearch.h); com greedy ou zero, a própria gulosa (em zero ela
+// só serve de ponto de calibração das temperaturas).
+static LocalSearchScratch localScratch;
+const Solution &prepareStart(const Solution &greedy, const RunOptions &opts){
+	if(opts.start != START_LOCAL) return greedy;
+	Solution &s = work.startSol;
+	s.copyFrom(greedy);
+	improveBySwaps(itens, maxWeight, s, localScratch, opts.lsRounds);
+	return s;
+}
 
-	// Heurística gulosa: ordena por lucro/peso (decrescente) e seleciona enquanto couber.
+// Núcleo reduzido da instância (--reduce), reaproveitado entre instâncias, e o lucro dos
+// itens fixados em 1, somado à trajetória gravada enquanto o SA roda sobre o núcleo
+static ReducedProblem reduced;
+static long long coreProfitOffset = 0;
 
-	// Estrutura auxiliar
-	struct Item { int idx; long long profit; long long weight; double ratio; };
-	std::vector<Item> items;
-	items.reserve(size);
-	// Calcula a razão e preenche o vetor
-	for(int i=0; i<size; ++i){
-		long long p = itens[i][0];
-		long long w = itens[i][1];
-		double r = (w > 0) ? static_cast<double>(p) / static_cast<double>(w) : DBL_MAX;
-		items.push_back({i, p, w, r});
-	}
-	// Ordena por razão decrescente; empate: maior lucro, depois menor peso.
-	std::sort(items.begin(), items.end(), [](const Item& a, const Item& b){
-		if(a.ratio == b.ratio){
-			// Critério de desempate
-			if(a.profit == b.profit) return a.weight < b.weight;
-			return a.profit > b.profit;
+// Enquanto existe, o núcleo ocupa o lugar da instância carregada (itens/size/maxWeight,
+// trocados sem cópia), de modo que o SA roda sobre ele sem mudanças
+struct CoreScope {
+	explicit CoreScope(ReducedProblem &r) : red(r) { swapIn(); coreProfitOffset = red.fixedProfit; }
+	~CoreScope(){ swapIn(); coreProfitOffset = 0; }
+	void swapIn(){ itens.swap(red.core); std::swap(maxWeight, red.capacity); size = itens.n; }
+	ReducedProblem &red;
+};
+
+// A parte de start que cai no núcleo pode não caber na capacidade residual (start não
+// tinha algum item fixado em 1): tira os de menor razão (o núcleo está em ordem de razão)
+// e, com --start ls, refaz a busca local no núcleo
+void repairCoreStart(Solution &coreStart, const RunOptions &opts){
+	const ItemStore &core = reduced.core;
+	long long profit = 0, weight = 0;
+	solutionTotals(core, coreStart, profit, weight);
+	for(int k=core.n-1; k>=0 && weight > reduced.capacity; --k){
+		if(coreStart.get(k)){ coreStart.set(k, false); weight -= core.weight[k]; }
+	}
+	if(opts.start == START_LOCAL) improveBySwaps(core, reduced.capacity, coreStart, localScratch, opts.lsRounds);
+	else fillByRatio(core, reduced.capacity, coreStart, profit, weight, localScratch.fit);
+}
+
+// SA a partir de start (viável). Com --reduce a instância é reduzida tendo start como
+// incumbente (common/reduction.h) e o SA roda só sobre o núcleo, partindo da parte de
+// start que cai nele. Sem --reduce, ou se não sobra núcleo, roda sobre a instância
+// inteira. Nos dois casos a melhor solução volta em out, ou start se o SA não a superar.
+// Com --start zero, start é a gulosa (ponto de calibração): ela é a incumbente da
+// redução e o piso do resultado, embora as cadeias partam da solução zerada.
+// As temperaturas são calibradas na instância inteira: no núcleo sobram muitos itens
+// pequenos (os grandes dominados saem), e a calibração nele daria um T0 que quase não
+// move os itens grandes.
+SAChain &annealFromStart(const char* label, const Solution &start, double penaltyCoef, const RunOptions &opts,
+                         long long stopAt, Solution &out, long long &outProfit){
+	KNAPSA_PHASE(PHASE_SA);
+	long long startProfit = calculateSolProfit(start);
+	TemperatureSchedule schedule = startSchedule(start, penaltyCoef, opts);
+	SAChain *best = nullptr;
+	if(opts.reduce){
+		reduceProblem(itens, maxWeight, startProfit, reduced);
+		if(!reduced.closed && reduced.n() >= 2){
+			reduced.restrict(start, work.coreStart);
+			repairCoreStart(work.coreStart, opts);
+			long long coreStop = (stopAt > 0) ? stopAt - reduced.fixedProfit : -1;
+			{
+				CoreScope scope(reduced);
+				best = &runAnnealing(label, work.coreStart, schedule, penaltyCoef, opts, coreStop);
+			}
+			reduced.expand(best->bestSol, out);
 		}
-		return a.ratio > b.ratio;
-	});
+	}
+	if(best == nullptr){
+		best = &runAnnealing(label, start, schedule, penaltyCoef, opts, stopAt);
+		out.copyFrom(best->bestSol);
+	}
+	outProfit = calculateSolProfit(out);
+	if(outProfit < startProfit){ out.copyFrom(start); outProfit = startProfit; }
+	return *best;
+}
 
-	// Seleciona itens na ordem gulosa se couberem
-	auto greedyStart = std::chrono::high_resolution_clock::now();
-	int remainingCapacity = maxWeight;
-	for(const auto& it : items){
-		if(it.weight <= remainingCapacity){
-			sol[it.idx] = true;
-			remainingCapacity -= it.weight;
+// T0/Tf calibradas em torno de start (fluxo próprio da semente, não altera os fluxos das
+// cadeias); inválida com --temp fixed
+TemperatureSchedule startSchedule(const Solution &start, double penaltyCoef, const RunOptions &opts){
+	TemperatureSchedule schedule;
+	if(opts.autoTemp){
+		TemperatureTargets targets;
+		if(opts.initialAcceptance >= 0.0) targets.initialAcceptance = opts.initialAcceptance;
+		else if(opts.start != START_ZERO) targets.initialAcceptance = WARM_INITIAL_ACCEPTANCE;
+		targets.finalAcceptance = opts.finalAcceptance;
+		schedule = calibrateTemperatures(start, penaltyCoef, opts.seed, targets);
+	}
+	return schedule;
+}
+
+// SA sobre a instância carregada: roda opts.chains cadeias com o esquema schedule, que
+// partem de start (ou da solução zerada com --start zero); a cadeia k usa o fluxo da
+// semente após k saltos (jump), então --chains 1 (padrão) reproduz a execução de uma
+// cadeia só. Com --trace grava a trajetória de cada cadeia. Devolve a melhor cadeia.
+SAChain &runAnnealing(const char* label, const Solution &start, const TemperatureSchedule &schedule, double penaltyCoef,
+                      const RunOptions &opts, long long stopAt){
+	int nChains = resolveThreadCount(opts.chains);
+	if(static_cast<int>(chains.size()) < nChains) chains.resize(nChains);
+	Rng stream(opts.seed);
+	for(int k=0; k<nChains; ++k){
+		if(opts.start == START_ZERO) chains[k].currentSol.resize(size);
+		else chains[k].currentSol.copyFrom(start);
+		chains[k].rng = stream;
+		chains[k].metropolis.exact = opts.exactAccept;
+		chains[k].metropolis.reset();
+		chains[k].schedule = schedule;
+		chains[k].stopAt = stopAt;
+		stream.jump();
+	}
+
+	if(nChains == 1){
+		runChain(chains[0], penaltyCoef, nullptr, opts);
+	}else{ // uma thread por cadeia; a thread principal roda a cadeia 0
+		BestSlot slot;
+		std::vector<std::thread> threads;
+		threads.reserve(nChains - 1);
+		for(int k=1; k<nChains; ++k)
+			threads.emplace_back(runChain, std::ref(chains[k]), penaltyCoef, &slot, std::cref(opts));
+		runChain(chains[0], penaltyCoef, &slot, opts);
+		for(auto &th : threads) th.join();
+	}
+	int bestChain = 0;
+	for(int k=1; k<nChains; ++k)
+		if(chains[k].bestProfit > chains[bestChain].bestProfit) bestChain = k;
+	if(traceFile != NULL){ // trajetória anytime de cada cadeia
+		for(int k=0; k<nChains; ++k)
+			for(const TracePoint &tp : chains[k].trace)
+				fprintf(traceFile, "%s,%d,%lld,%lld,%lld\n", label, k, tp.elapsedUs, tp.evals, tp.bestProfit + coreProfitOffset);
+		fflush(traceFile);
+	}
+	return chains[bestChain];
+}
+
+// Opções que mudam o resultado de uma instância (a semente entra à parte na chave, e
+// --cache-invalidate descarta todas as sementes de um conjunto de parâmetros)
+uint64_t parameterHash(const RunOptions &opts){
+	Hash128 h;
+	h.add(static_cast<uint64_t>(opts.exact));
+	h.add(static_cast<uint64_t>(opts.portfolio));
+	if(opts.portfolio) h.add(static_cast<uint64_t>(opts.portfolioMs));
+	if(opts.exact != EXACT_DP){ // SA (sozinho, antes do B&B ou na corrida)
+		double penalty = static_cast<double>(opts.penaltyFactor);
+		h.add(&penalty, sizeof(penalty));
+		h.add(static_cast<uint64_t>(resolveThreadCount(opts.chains)));
+		h.add(static_cast<uint64_t>(opts.exchangeEvery));
+		h.add(static_cast<uint64_t>(opts.exactAccept));
+		h.add(static_cast<uint64_t>(opts.timeLimitMs));
+		h.add(static_cast<uint64_t>(opts.maxEvals));
+		h.add(static_cast<uint64_t>(opts.autoTemp));
+		h.add(static_cast<uint64_t>(opts.start));
+		h.add(static_cast<uint64_t>(opts.lsRounds));
+		h.add(static_cast<uint64_t>(opts.reduce));
+		h.add(static_cast<uint64_t>(stopAtOptimum));
+		// Só fora do padrão, para as chaves já gravadas (cache, diário) continuarem valendo
+		if(opts.initialAcceptance >= 0.0 || opts.finalAcceptance != 0.001 || opts.levelFactor != 0.5 || opts.alpha != 0.99){
+			double tuned[4] = {opts.initialAcceptance, opts.finalAcceptance, opts.levelFactor, opts.alpha};
+			h.add(tuned, sizeof(tuned));
 		}
 	}
+	if(opts.exact == EXACT_DP || opts.portfolio){
+		h.add(static_cast<uint64_t>(opts.dp.reconstruct));
+		h.add(static_cast<uint64_t>(opts.dp.maxBytes));
+	}
+	if(opts.exact == EXACT_BB || opts.portfolio){
+		h.add(static_cast<uint64_t>(opts.bb.maxNodes));
+		h.add(static_cast<uint64_t>(opts.bb.timeLimitMs));
+	}
+	return h.lo ^ h.hi;
+}
+
+// Execução reprodutível pela chave: prazos de relógio (--time-limit-ms do SA,
+// --bb-time-ms, --portfolio-ms) fazem o resultado depender da máquina e da carga,
+// então essas execuções nem consultam nem gravam o cache
+bool cacheableRun(const RunOptions &opts){
+	bool sa = opts.exact != EXACT_DP || opts.portfolio;
+	bool bb = opts.exact == EXACT_BB || opts.portfolio;
+	if(sa && opts.timeLimitMs > 0) return false;
+	if(bb && opts.bb.timeLimitMs > 0) return false;
+	return !(opts.portfolio && opts.portfolioMs > 0);
+}
 
-	long long greedyProfit = calculateSolProfit(sol);
+// Chave do cache da instância carregada
+Hash128 resultKey(const RunOptions &opts, uint64_t params){
+	Hash128 key = instanceHash(itens, maxWeight);
+	key.add(static_cast<uint64_t>(SOLVER_VERSION));
+	key.add(static_cast<uint64_t>(opts.portfolio ? ALGORITHM_PORTFOLIO : opts.exact));
+	key.add(params);
+	key.add(static_cast<uint64_t>(opts.seed));
+	return key;
+}
+
+// Entrada do cache para a instância carregada, se houver uma cuja solução gravada
+// (quando existe) confere com o lucro gravado
+const ResultCacheRecord *cachedResult(const Hash128 &key){
+	const ResultCacheRecord *r = resultCache.find(key);
+	if(r == nullptr || r->n != static_cast<uint32_t>(size)) return nullptr;
+	if(r->words == 0) return r;
+	Solution &sol = work.cachedSol;
+	sol.resize(size);
+	if(static_cast<uint32_t>(sol.words) != r->words) return nullptr;
+	memcpy(sol.bits.data(), ResultCache::solutionWords(r), sizeof(uint64_t) * r->words);
+	return calculateSolProfit(sol) == r->profit ? r : nullptr;
+}
+
+// Gulosa + SA sobre a instância carregada em itens/size/maxWeight. false se o prazo da
+// instância (instanceCancel) acabou: nada é impresso nem gravado no cache.
+bool solveLoadedInstance(const char* label, const RunOptions &opts){
+	long long optimum = optimaLoaded ? optima.find(instanceNameFromPath(label)) : -1;
+	Hash128 key;
+	uint64_t params = 0;
+	const bool cached = resultCache.isOpen() && cacheableRun(opts);
+	if(cached){ // já resolvida com a mesma chave: só imprime
+		params = parameterHash(opts);
+		key = resultKey(opts, params);
+		if(const ResultCacheRecord *r = cachedResult(key)){
+			++resultCache.hits;
+			printResult(label, opts, ResultCache::toRunRecord(r), optimum);
+			return true;
+		}
+		++resultCache.misses;
+	}
+
+	double penaltyCoef = penaltyCoefficient(opts.penaltyFactor);
+
+	Solution &sol = work.greedySol; // zerada
+	sol.resize(size);
+
+	auto start = std::chrono::steady_clock::now(); // referência do tempo até a melhor
+	auto greedyStart = std::chrono::high_resolution_clock::now();
+	long long greedyProfit = greedySolution(sol);
 	auto greedyEnd = std::chrono::high_resolution_clock::now();
 	auto greedyMs = std::chrono::duration_cast<std::chrono::milliseconds>(greedyEnd - greedyStart).count();
 
+	RunRecord rec;
+	const Solution *result = nullptr; // solução gravada no cache (nenhuma: DP sem --reconstruct)
+	if(opts.portfolio){
+		double greedyAtMs = std::chrono::duration<double, std::milli>(greedyEnd - greedyStart).count();
+		rec = solvePortfolio(label, opts, sol, greedyProfit, greedyAtMs, (stopAtOptimum && optimum > 0) ? optimum : -1, start, result);
+	}else if(opts.exact == EXACT_DP){ // DP: a gulosa serve de incumbente, sem SA
+		rec = solveExact(label, opts, sol, greedyProfit, 0);
+		if(opts.dp.reconstruct) result = &work.exactSol;
+	}else{
+		// SA parte da gulosa melhorada por busca local (--start; o tempo dela conta no SA)
+		auto saStart = std::chrono::high_resolution_clock::now();
+		const Solution &startSol = prepareStart(sol, opts);
+		Solution &bestSol = work.saSol;
+		long long saProfit;
+		SAChain &best = annealFromStart(label, startSol, penaltyCoef, opts, (stopAtOptimum && optimum > 0) ? optimum : -1, bestSol, saProfit);
+
+		auto saEnd = std::chrono::high_resolution_clock::now();
+		auto saMs = std::chrono::duration_cast<std::chrono::milliseconds>(saEnd - saStart).count();
+		if(opts.exact == EXACT_BB){ // B&B parte da melhor entre gulosa e SA
+			bool saBetter = saProfit > greedyProfit;
+			rec = solveExact(label, opts, saBetter ? bestSol : sol, saBetter ? saProfit : greedyProfit, static_cast<long long>(saMs));
+			result = &work.exactSol;
+		}else{
+			rec.profit = saProfit;
+			rec.solveMs = static_cast<long long>(saMs);
+			rec.bestMs = std::chrono::duration<double, std::milli>(best.bestAt - start).count();
+			result = &bestSol;
+		}
+	}
+	rec.algorithm = opts.portfolio ? ALGORITHM_PORTFOLIO : opts.exact;
+	rec.greedyProfit = greedyProfit;
+	rec.greedyMs = static_cast<long long>(greedyMs);
+	if(rec.algorithm == EXACT_DP || rec.algorithm == EXACT_BB) // sem trajetória: o tempo até a melhor é o tempo total
+		rec.bestMs = static_cast<double>(rec.greedyMs + rec.solveMs);
+	if(instanceCancel.wasCancelled()) return false;
+	if(cached) resultCache.store(key, params, opts.seed, size, rec, result);
+	printResult(label, opts, rec, optimum);
+	return true;
+}
+
+// Linha CSV da instância (resolvida agora ou vinda do cache).
+// SA: instancia,lucro_guloso,lucro_sa,tempo_guloso_ms,tempo_sa_ms,tempo_total_ms
+// Exato: instancia,lucro_guloso,lucro_exato,tempo_guloso_ms,tempo_exato_ms,tempo_total_ms,status,limite_superior,gap_pct
+// status = optimal (provado), memory_limit (DP acima de --dp-max-mb) ou budget (B&B esgotou
+// nós/tempo); fora de optimal, lucro_exato é a melhor solução conhecida e gap_pct a distância
+// relativa ao limite superior. tempo_exato_ms inclui o SA antes do B&B.
+// Portfolio: as colunas do modo exato (status optimal, budget ou deadline = --portfolio-ms)
+// mais vencedor,tempo_vencedor_ms (método da melhor solução e quando ela foi achada).
+// (+ colunas de qualidade com --optima)
+void printResult(const char* label, [[maybe_unused]] const RunOptions &opts, const RunRecord &rec, long long optimum){
+	long long totalMs = rec.greedyMs + rec.solveMs;
+	csvLine.clear();
+	csvf("%s,%lld,%lld,%lld,%lld,%lld", label, rec.greedyProfit, rec.profit, rec.greedyMs, rec.solveMs, totalMs);
+	const char *algorithm = "sa";
+	if(rec.algorithm != EXACT_NONE){
+		algorithm = (rec.algorithm == EXACT_DP) ? "dp" : (rec.algorithm == EXACT_BB) ? "bb" : "portfolio";
+		const char *status = (rec.status == RESULT_OPTIMAL) ? "optimal" : (rec.status == RESULT_DEADLINE) ? "deadline" :
+		                     (rec.algorithm == EXACT_DP) ? "memory_limit" : "budget";
+		double gap = (rec.upperBound > 0) ? 100.0 * static_cast<double>(rec.upperBound - rec.profit) / static_cast<double>(rec.upperBound) : 0.0;
+		csvf(",%s,%lld,%.6f", status, rec.upperBound, gap);
+		if(rec.algorithm == ALGORITHM_PORTFOLIO)
+			csvf(",%s,%.3f", ENGINE_NAMES[rec.engine < ENGINE_COUNT ? rec.engine : 0], rec.bestMs);
+	}
+	if(optimaLoaded)
+		reportQuality(label, optimum, rec.greedyProfit, rec.greedyMs, algorithm, rec.profit, rec.bestMs, static_cast<double>(totalMs));
+	KNAPSA_STAT(if(rec.algorithm == EXACT_NONE) reportInstrumentation(label, resolveThreadCount(opts.chains));)
+	fputs(csvLine.c_str(), stdout);
+	fputc('\n', stdout);
+}
+
+void csvf(const char *fmt, ...){
+	char buf[256];
+	va_list ap;
+	va_start(ap, fmt);
+	int len = vsnprintf(buf, sizeof(buf), fmt, ap);
+	va_end(ap);
+	if(len < static_cast<int>(sizeof(buf))){ csvLine.append(buf, len > 0 ? len : 0); return; }
+	std::string big(static_cast<size_t>(len) + 1, '\0'); // rótulo longo
+	va_start(ap, fmt);
+	vsnprintf(&big[0], big.size(), fmt, ap);
+	va_end(ap);
+	csvLine.append(big, 0, static_cast<size_t>(len));
+}
+
+// Modo exato: resolve a instância carregada a partir da incumbente; a solução fica em
+// work.exactSol (DP só com --reconstruct). solveMs inclui heuristicMs (SA antes do B&B).
+RunRecord solveExact(const char* label, const RunOptions &opts, const Solution &incumbent, long long incumbentProfit,
+                     long long heuristicMs){
+	auto exactStart = std::chrono::high_resolution_clock::now();
+	Solution &out = work.exactSol;
+	ExactResult res;
+	if(opts.exact == EXACT_DP)
+		res = solveExactDP(itens, maxWeight, incumbent, incumbentProfit, opts.dp, opts.dp.reconstruct ? &out : nullptr);
+	else
+		res = solveBranchAndBound(itens, maxWeight, incumbent, incumbentProfit, opts.bb, &out);
+	auto exactEnd = std::chrono::high_resolution_clock::now();
+	bool hasSolution = (opts.exact == EXACT_BB) || opts.dp.reconstruct;
+	if(hasSolution && calculateSolProfit(out) != res.profit) // confere a solução devolvida
+		fprintf(stderr,"WARNING: solution of %s has profit %lld, expected %lld\n", label, calculateSolProfit(out), res.profit);
+	RunRecord rec;
+	rec.profit = res.profit;
+	rec.upperBound = res.upperBound;
+	rec.status = res.optimal ? RESULT_OPTIMAL : RESULT_LIMIT;
+	rec.solveMs = heuristicMs + std::chrono::duration_cast<std::chrono::milliseconds>(exactEnd - exactStart).count();
+	return rec;
+}
+
+// Corrida (--portfolio) a partir da gulosa: B&B e DP em threads próprias sobre uma cópia
+// dos itens (o SA troca itens pelo núcleo reduzido enquanto roda) e o SA nesta thread.
+// Termina quando os três terminam; uma prova de otimalidade (DP ou B&B completos) cancela
+// os demais, e --portfolio-ms (ou --instance-timeout-ms) cancela todos. O vencedor é o de
+// maior lucro (empate: o que chegou antes); o limite superior é o menor provado.
+// result aponta para a solução do vencedor (nenhuma se for a DP sem --reconstruct).
+static ItemStore raceItems;
+RunRecord solvePortfolio(const char* label, const RunOptions &opts, const Solution &greedy, long long greedyProfit,
+                         double greedyAtMs, long long stopAt, std::chrono::steady_clock::time_point start, const Solution *&result){
+	struct EngineRun {
+		long long profit = -1, upperBound = -1;
+		bool optimal = false;
+		double atMs = 0.0;           // desde o início da gulosa
+		const Solution *sol = nullptr;
+	};
+	EngineRun runs[ENGINE_COUNT];
+	runs[ENGINE_GREEDY].profit = greedyProfit;
+	runs[ENGINE_GREEDY].atMs = greedyAtMs;
+	runs[ENGINE_GREEDY].sol = &greedy;
+	auto elapsedMs = [start](){ return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(); };
+
+	raceItems.resize(size);
+	memcpy(raceItems.profit, itens.profit, sizeof(long long) * size);
+	memcpy(raceItems.weight, itens.weight, sizeof(long long) * size);
+	raceItems.finalize();
+	raceItems.ratioOrder(); // ordenada antes: B&B e DP só leem
+	const long long capacity = maxWeight;
+	SharedBound bound;
+	bound.offer(greedyProfit);
+	raceCancel.parent = &instanceCancel;
+	raceCancel.arm(opts.portfolioMs);
+	std::atomic<bool> proved{false};
+	auto raceStart = std::chrono::high_resolution_clock::now();
+
+	std::thread bbThread([&](){
+		BBOptions bo = opts.bb;
+		bo.cancel = &raceCancel;
+		bo.shared = &bound;
+		ExactResult r = solveBranchAndBound(raceItems, capacity, greedy, greedyProfit, bo, &work.exactSol);
+		EngineRun &e = runs[ENGINE_BB];
+		e.atMs = elapsedMs();
+		e.profit = r.profit; e.upperBound = r.upperBound; e.optimal = r.optimal && !r.cancelled;
+		e.sol = &work.exactSol;
+		if(e.optimal){ proved = true; raceCancel.cancel(); }
+	});
+	std::thread dpThread([&](){
+		DPOptions dopt = opts.dp;
+		dopt.cancel = &raceCancel;
+		ExactResult r = solveExactDP(raceItems, capacity, greedy, greedyProfit, dopt, dopt.reconstruct ? &work.dpSol : nullptr);
+		EngineRun &e = runs[ENGINE_DP];
+		e.atMs = elapsedMs();
+		e.profit = r.profit; e.upperBound = r.upperBound; e.optimal = r.optimal && !r.cancelled;
+		e.sol = dopt.reconstruct ? &work.dpSol : nullptr;
+		if(e.optimal){ bound.offer(r.profit); proved = true; raceCancel.cancel(); }
+	});
+
+	raceBound = &bound;
+	saCancel = &raceCancel;
+	const Solution &startSol = prepareStart(greedy, opts);
+	long long saProfit;
+	SAChain &best = annealFromStart(label, startSol, penaltyCoefficient(opts.penaltyFactor), opts, stopAt, work.saSol, saProfit);
+	raceBound = nullptr;
+	saCancel = &instanceCancel;
+	runs[ENGINE_SA].profit = saProfit;
+	runs[ENGINE_SA].atMs = std::max(greedyAtMs, std::chrono::duration<double, std::milli>(best.bestAt - start).count());
+	runs[ENGINE_SA].sol = &work.saSol;
+	bbThread.join();
+	dpThread.join();
+	auto raceEnd = std::chrono::high_resolution_clock::now();
 
-	bool bestSol[size];
-	// SA inicia com solução zerada (não usar a gulosa como base)
-	for(int i=0; i<size; ++i) bestSol[i] = false;
-// 	S.A.
-	//implement simulated annealing
+	RunRecord rec;
+	int winner = ENGINE_GREEDY;
+	long long upperBound = -1;
+	for(int k=0; k<ENGINE_COUNT; ++k){
+		const EngineRun &e = runs[k];
+		if(e.profit > runs[winner].profit || (e.profit == runs[winner].profit && e.atMs < runs[winner].atMs)) winner = k;
+		if(e.upperBound >= 0 && (upperBound < 0 || e.upperBound < upperBound)) upperBound = e.upperBound;
+	}
+	rec.engine = winner;
+	rec.profit = runs[winner].profit;
+	rec.upperBound = std::max(upperBound, rec.profit);
+	rec.bestMs = runs[winner].atMs;
+	rec.status = (proved || rec.profit >= rec.upperBound) ? RESULT_OPTIMAL :
+	             (raceCancel.wasCancelled() && !instanceCancel.wasCancelled()) ? RESULT_DEADLINE : RESULT_LIMIT;
+	rec.solveMs = std::chrono::duration_cast<std::chrono::milliseconds>(raceEnd - raceStart).count();
+	result = runs[winner].sol;
+	if(result != nullptr && calculateSolProfit(*result) != rec.profit) // confere a solução do vencedor
+		fprintf(stderr,"WARNING: solution of %s (%s) has profit %lld, expected %lld\n", label, ENGINE_NAMES[winner],
+		        calculateSolProfit(*result), rec.profit);
+	return rec;
+}
 
+// Uma cadeia de SA sobre a instância carregada (itens/size/maxWeight, somente leitura).
+// Com slot != nullptr, a cada opts.exchangeEvery temperaturas a cadeia publica sua melhor
+// solução e, se outra cadeia já achou algo melhor, continua a partir dela.
+// Com orçamento (--time-limit-ms / --max-evals) o resfriamento deixa de ser alpha fixo:
+// a temperatura segue T0 * (Tf/T0)^progresso, onde progresso é a fração consumida do
+// orçamento, e a cadeia para quando ele acaba (o relógio é lido a cada 1024 movimentos).
+// Com chain.schedule válida (--temp auto) T0/Tf vêm da calibração e cada patamar termina
+// após levelAccepts aceitações (no máximo levelLength tentativas, como no modo fixo):
+// curto em temperatura alta, onde quase tudo é aceito, e completo perto do congelamento;
+// a cadeia para antes de Tf se FROZEN_LEVELS patamares seguidos não aceitarem nada.
+void runChain(SAChain &chain, double penaltyCoef, BestSlot *slot, const RunOptions &opts){
 	// Parâmetros do Simulated Annealing (SA): temperatura inicial/final e taxa de resfriamento (alpha)
 	double initialTemp = 10000.0;
 	double finalTemp = 0.1;
-	double alpha = 0.99; // cooling rate
-
-	// Gerador aleatório e uniforme [0,1)
-	static std::mt19937 rng(std::random_device{}());
-	std::uniform_real_distribution<double> urand(0.0, 1.0);
+	const double alpha = opts.alpha; // cooling rate (--alpha, padrão 0.99)
+	const bool adaptive = chain.schedule.valid();
+	if(adaptive){
+		initialTemp = chain.schedule.initial;
+		finalTemp = chain.schedule.final;
+	}
+	const int levelLength = std::max(10, static_cast<int>(size * opts.levelFactor)); // --level-factor (padrão n/2)
+	const int levelAccepts = std::max(10, levelLength / 8);
+	const int FROZEN_LEVELS = 3;
+	int frozenLevels = 0;
 
-	// Estado atual e vizinho; inicia com solução zerada
-	bool currentSol[size];
-	for(int i=0; i<size; ++i) currentSol[i] = false; // solução inicial zerada
-	long long currentProfit = calculateSolProfit(currentSol);
-	long long bestProfit = currentProfit;
-	long long currentWeight = 0; // solução zerada tem peso 0
-	// Não usar a gulosa como solução inicial do SA
+	Rng &rng = chain.rng; // gerador da cadeia
 
-	bool neighborSol[size];
+	// Estado atual (movimentos aplicados in-place); a solução inicial vem de runAnnealing
+	// (zerada com --start zero, senão a gulosa ou a gulosa após a busca local)
+	Solution &currentSol = chain.currentSol;
+	Solution &bestSol = chain.bestSol;
+	bestSol.resize(size);
+	long long currentProfit = 0, currentWeight = 0;
+	solutionTotals(itens, currentSol, currentProfit, currentWeight);
+	long long bestProfit = 0;
+	if(currentWeight <= maxWeight){
+		bestProfit = currentProfit;
+		bestSol.copyFrom(currentSol);
+	}
 
 	double temperature = initialTemp;
 	double currentScore = calculatePenalizedScore(currentSol, penaltyCoef);
-	auto saStart = std::chrono::high_resolution_clock::now();
-	while(temperature > finalTemp){
-		int innerLoops = (size >= 20) ? (size/2) : 10; // mais tentativas por temperatura
-		for(int it = 0; it < innerLoops; ++it){
-			memcpy(neighborSol, currentSol, sizeof(bool)*size); // copia a solução atual
+	int level = 0;
+
+	// Orçamento e trajetória anytime
+	const bool budgeted = (opts.timeLimitMs > 0 || opts.maxEvals > 0);
+	const bool tracing = (traceFile != NULL);
+	const int exchangeEvery = opts.exchangeEvery;
+	auto chainStart = std::chrono::steady_clock::now();
+	auto elapsedUs = [&chainStart](){
+		return static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - chainStart).count());
+	};
+	long long evals = 0;
+	double progress = 0.0;
+	auto updateProgress = [&](){
+		double p = 0.0;
+		if(opts.maxEvals > 0) p = static_cast<double>(evals) / static_cast<double>(opts.maxEvals);
+		if(opts.timeLimitMs > 0) p = std::max(p, static_cast<double>(elapsedUs()) / (1000.0 * static_cast<double>(opts.timeLimitMs)));
+		progress = p;
+	};
+	chain.trace.clear();
+	if(tracing) chain.trace.push_back({0, 0, bestProfit});
+	chain.bestAt = chainStart;
+	const long long stopAt = chain.stopAt;
+	bool reached = false; // --stop-at-optimum: ótimo conhecido atingido
+	KNAPSA_STAT(chain.stats.reset();)
+
+	while(budgeted ? progress < 1.0 : temperature > finalTemp){
+		int accepted = 0;
+		KNAPSA_STAT(LevelStats lv; lv.temperature = temperature; uint64_t levelStart = readCycles();)
+		for(int it = 0; it < levelLength; ++it){
+			if(adaptive && accepted >= levelAccepts) break; // patamar em equilíbrio
+			if(budgeted){
+				if(opts.maxEvals > 0 && evals >= opts.maxEvals){ progress = 1.0; break; }
+				if((evals & 1023) == 0 && opts.timeLimitMs > 0){
+					updateProgress();
+					if(progress >= 1.0) break;
+				}
+			}
+			++evals;
 			int f1=-1, f2=-1; bool two=false;
-			tweak(neighborSol, f1, f2, two); // aplica mutação (bit flip) e devolve índices
+			tweak(rng, f1, f2, two); // sorteia o movimento (bit flip) sem alterar a solução
 
-			// Avaliação incremental
+			// Avaliação incremental: delta calculado a partir do estado atual dos bits
 			long long neighborProfit = currentProfit;
 			long long neighborWeight = currentWeight;
 			if(f1>=0){
-				if(neighborSol[f1]){ neighborProfit += itens[f1][0]; neighborWeight += itens[f1][1]; }
-				else{ neighborProfit -= itens[f1][0]; neighborWeight -= itens[f1][1]; }
+				if(!currentSol.get(f1)){ neighborProfit += itens.profit[f1]; neighborWeight += itens.weight[f1]; }
+				else{ neighborProfit -= itens.profit[f1]; neighborWeight -= itens.weight[f1]; }
 			}
 			if(two && f2>=0){
-				if(neighborSol[f2]){ neighborProfit += itens[f2][0]; neighborWeight += itens[f2][1]; }
-				else{ neighborProfit -= itens[f2][0]; neighborWeight -= itens[f2][1]; }
+				if(!currentSol.get(f2)){ neighborProfit += itens.profit[f2]; neighborWeight += itens.weight[f2]; }
+				else{ neighborProfit -= itens.profit[f2]; neighborWeight -= itens.weight[f2]; }
 			}
 
 			// Score penalizado
 			long long excess = (neighborWeight > maxWeight) ? (neighborWeight - maxWeight) : 0;
 			double neighborScore = static_cast<double>(neighborProfit) - penaltyCoef * static_cast<double>(excess);
 			double delta = neighborScore - currentScore; // melhora/piora no score penalizado
+			KNAPSA_STAT(++lv.moves; if(excess > 0) ++lv.infeasible;)
+
+			bool accept = (delta >= 0.0); // melhor (ou igual): aceita
+			if(!accept){ // pior: aceita com probabilidade exp(delta/temperatura)
+				// Teste equivalente: aceite se delta >= T * ln(u), u ~ U(0,1], com ln(u) pré-calculado em bloco
+				accept = chain.metropolis.accept(rng, delta, temperature);
+			}
 
-			if(delta >= 0.0){ // melhor (ou igual): aceita
-				memcpy(currentSol, neighborSol, sizeof(bool)*size);
+			if(accept){ // aplica o movimento no próprio currentSol (sem cópias)
+				++accepted;
+				KNAPSA_STAT(++lv.accepts; if(delta < 0.0) ++lv.uphill; if(excess > 0) ++lv.infeasibleAccepted;)
+				currentSol.flip(f1);
+				if(two && f2>=0) currentSol.flip(f2);
 				currentProfit = neighborProfit;
 				currentWeight = neighborWeight;
 				currentScore = neighborScore;
-			}else{ // pior: aceita com probabilidade exp(delta/temperatura)
-				// Teste equivalente: aceite se delta >= T * ln(u), u ~ U(0,1)
-				double u = urand(rng);
-				if(u <= 0.0) u = std::numeric_limits<double>::min();
-				double threshold = temperature * std::log(u);
-				if(delta >= threshold){
-					memcpy(currentSol, neighborSol, sizeof(bool)*size);
-					currentProfit = neighborProfit;
-					currentWeight = neighborWeight;
-					currentScore = neighborScore;
+
+				// Atualiza a melhor solução (só muda quando um movimento é aceito)
+				if(currentWeight <= maxWeight && currentProfit > bestProfit){
+					bestProfit = currentProfit;
+					bestSol.copyFrom(currentSol); // cópia de size/64 palavras
+					chain.bestAt = std::chrono::steady_clock::now();
+					if(raceBound != nullptr) raceBound->offer(bestProfit + coreProfitOffset); // --portfolio
+					KNAPSA_STAT(++chain.stats.improvements; chain.stats.lastImproveMove = evals;
+					            chain.stats.lastImproveLevel = static_cast<long long>(chain.stats.levels.size());)
+					if(tracing) chain.trace.push_back({elapsedUs(), evals, bestProfit});
+					if(stopAt > 0 && bestProfit >= stopAt){
+						reached = true;
+						if(slot != nullptr) slot->publish(bestSol, bestProfit); // encerra as outras cadeias
+						break;
+					}
 				}
 			}
+		}
+		KNAPSA_STAT(lv.cycles = readCycles() - levelStart; chain.stats.total.add(lv); chain.stats.levels.push_back(lv);)
+		if(reached || (stopAt > 0 && slot != nullptr && slot->profit.load(std::memory_order_relaxed) >= stopAt))
+			break; // ótimo conhecido atingido (por esta ou outra cadeia)
+		if(saCancel->cancelled()) break; // --instance-timeout-ms, ou a corrida (--portfolio) acabou
+		if(adaptive){ // congelada: nenhum movimento aceito em FROZEN_LEVELS patamares seguidos
+			frozenLevels = (accepted == 0) ? frozenLevels + 1 : 0;
+			if(frozenLevels >= FROZEN_LEVELS) break;
+		}
+		if(budgeted){ // temperatura pela fração consumida do orçamento
+			updateProgress();
+			temperature = initialTemp * std::pow(finalTemp / initialTemp, std::min(progress, 1.0));
+		}else
+			temperature *= alpha; // resfriamento geométrico
 
-			// Atualiza a melhor solução
-			if(currentWeight <= maxWeight && currentProfit > bestProfit){
-				bestProfit = currentProfit;
-				memcpy(bestSol, currentSol, sizeof(bool)*size);
+		if(slot != nullptr && exchangeEvery > 0 && ++level % exchangeEvery == 0){ // troca entre cadeias
+			slot->publish(bestSol, bestProfit);
+			long long shared;
+			if(slot->adopt(currentSol, bestProfit, shared)){
+				solutionTotals(itens, currentSol, currentProfit, currentWeight);
+				currentScore = static_cast<double>(currentProfit); // viável: sem penalidade
+				bestProfit = shared;
+				bestSol.copyFrom(currentSol);
+				chain.bestAt = std::chrono::steady_clock::now();
+				if(tracing) chain.trace.push_back({elapsedUs(), evals, bestProfit});
 			}
 		}
-		temperature *= alpha; // resfriamento geométrico
 	}
+	if(tracing) chain.trace.push_back({elapsedUs(), evals, bestProfit}); // ponto final da cadeia
+	chain.bestProfit = bestProfit;
+}
 
-
-	long long saProfit = calculateSolProfit(bestSol);
-	auto saEnd = std::chrono::high_resolution_clock::now();
-	auto saMs = std::chrono::duration_cast<std::chrono::milliseconds>(saEnd - saStart).count();
-	long long totalMs = static_cast<long long>(greedyMs + saMs);
-	// Saída CSV: instancia, lucro_guloso, lucro_sa, tempo_guloso_ms, tempo_sa_ms, tempo_total_ms
-	printf("%s,%lld,%lld,%lld,%lld,%lld\n", inputFile[1], greedyProfit, saProfit, (long long)greedyMs, (long long)saMs, totalMs);
-
+// Amostra movimentos aleatórios em torno de anchor (a gulosa ou a solução inicial: viável
+// e próxima das boas soluções, onde o fim do resfriamento acontece) e calibra T0/Tf pelas
+// pioras do score penalizado. Os movimentos não são aplicados.
+TemperatureSchedule calibrateTemperatures(const Solution &anchor, double penaltyCoef, unsigned int seed, const TemperatureTargets &targets){
+	Rng rng(streamSeed(seed, 0xCA1B));
+	long long profit = 0, weight = 0;
+	solutionTotals(itens, anchor, profit, weight);
+	double score = static_cast<double>(profit);
+	int samples = std::min(4000, 1000 + 2*size);
+	std::vector<double> worsening;
+	worsening.reserve(samples);
+	for(int k=0; k<samples; ++k){
+		int f1=-1, f2=-1; bool two=false;
+		tweak(rng, f1, f2, two);
+		long long np = profit, nw = weight;
+		if(f1>=0){
+			if(!anchor.get(f1)){ np += itens.profit[f1]; nw += itens.weight[f1]; }
+			else{ np -= itens.profit[f1]; nw -= itens.weight[f1]; }
+		}
+		if(two && f2>=0){
+			if(!anchor.get(f2)){ np += itens.profit[f2]; nw += itens.weight[f2]; }
+			else{ np -= itens.profit[f2]; nw -= itens.weight[f2]; }
+		}
+		long long excess = (nw > maxWeight) ? (nw - maxWeight) : 0;
+		double delta = static_cast<double>(np) - penaltyCoef * static_cast<double>(excess) - score;
+		if(delta < 0.0) worsening.push_back(-delta);
+	}
+	return calibrateSchedule(worsening, targets);
 }
-void tweak(bool *sol, int &idx1, int &idx2, bool &twoFlips){
-	// Mutação: bit flip de 1 bit; com 10% de chance, flip de 2 bits distintos
+
+void tweak(Rng &rng, int &idx1, int &idx2, bool &twoFlips){
+	// Mutação: bit flip de 1 bit; com 10% de chance, flip de 2 bits distintos.
+	// Apenas sorteia os índices; quem chama aplica (ou descarta) o movimento.
 	idx1 = -1; idx2 = -1; twoFlips = false;
 	if(size <= 0) return;
-	std::uniform_int_distribution<int> dist(0, size - 1);
-	std::uniform_real_distribution<double> urand(0.0, 1.0);
-	idx1 = dist(rng);
-	sol[idx1] = !sol[idx1];
-	if(urand(rng) < 0.10 && size > 1){
-		idx2 = dist(rng);
+	idx1 = static_cast<int>(rng.below(static_cast<uint32_t>(size)));
+	if(rng.uniform() < 0.10 && size > 1){
+		idx2 = static_cast<int>(rng.below(static_cast<uint32_t>(size)));
 		if(idx2 == idx1) idx2 = (idx1 + 1) % size; // garante distinto
-		sol[idx2] = !sol[idx2];
 		twoFlips = true;
 	}
 }
 
 // Calcula o lucro total; retorna -1 se ultrapassar a capacidade
-long long calculateSolProfit(const bool *sol){//calculate the profit of a given solution - invalid solutions get -1
+long long calculateSolProfit(const Solution &sol){//calculate the profit of a given solution - invalid solutions get -1
 	long long profit=0;
 	long long weight=0;
-	for(int i=0; i<size; i++){
-		if(sol[i]){
-			profit+=itens[i][0];//[profit, weight]
-			weight+=itens[i][1];
-		}
-	}
+	solutionTotals(itens, sol, profit, weight); // colunas mascaradas pelos bits
 	if(weight>maxWeight)
 		profit=-1;// inválida
 	return profit;
 }
 
 // Score penalizado: lucro - penaltyCoef * max(0, peso - maxWeight)
-double calculatePenalizedScore(const bool *sol, double penaltyCoef){
+double calculatePenalizedScore(const Solution &sol, double penaltyCoef){
 	long long profit = 0;
 	long long weight = 0;
-	for(int i=0; i<size; ++i){
-		if(sol[i]){
-			profit += itens[i][0];
-			weight += itens[i][1];
-		}
-	}
+	solutionTotals(itens, sol, profit, weight);
 	long long excess = (weight > maxWeight) ? (weight - maxWeight) : 0;
 	return static_cast<double>(profit) - penaltyCoef * static_cast<double>(excess);
 }
@@ -247,42 +1414,46 @@ double calculatePenalizedScore(const bool *sol, double penaltyCoef){
 // 0: N (número de itens)
 // 1..N: id lucro peso
 // N+1: capacidade (maxWeight)
-void readFile(const char* fileName){
-	char s[500];
-	FILE *stream = fopen(fileName, "r"); // abre em modo leitura
-	if( stream == NULL ){ // erro de abertura
-		fprintf(stderr,"\nFail to Open File!!\n");
-		exit(1);
+// (ou o formato binário .knpb / "<arquivo.knpa>:<nome>")
+// O arquivo é mapeado em memória e lido pelo scanner de common/instanceReader.h.
+bool readFile(const char* fileName){
+	KNAPSA_PHASE(PHASE_PARSE);
+	LoadDiag diag;
+	LoadStatus status = loadInstance(fileName, itens, maxWeight, &diag);
+	if(status == LOAD_OPEN_FAILED){ // erro de abertura
+		fprintf(stderr,"\nFail to Open File!! (%s)\n", fileName);
+		return false;
 	}
-	int line=-1;
-	while(fgets(s,500,stream)){ // lê linhas (<= 500 chars)
-		if(strlen(s)-1>0) // remove \n final
-			s[strlen(s)-1]='\0';
-		if(('\r'==s[strlen(s)-1]))// remove \r se existir
-			s[strlen(s)-1]=0;
-		
-		char* value1 = strtok(s," "); // tokens separados por espaço
-		char* value2 = strtok(NULL," ");
-		char* value3 = strtok(NULL," ");
-		line++;
-		
-		if(line==0){ // número de itens
-			size=atoi(value1);
-			itens=(long long**)malloc(size * sizeof(long long*));            
-			for (int i=0;i<size;i++)
-				itens[i] = (long long*)malloc(2 * sizeof(long long)); // [profit, weight]
-		}
-		
-		if(line>0 && line<size+1){ // itens: id, lucro, peso
-			int id=atoi(value1);
-			if(id!=line-1){
-				fprintf(stderr,"\nERROR! Invalid knapsack file, aborting!!\n");
-				exit(1);
-			}
-			itens[id][0]=atoll(value2);
-			itens[id][1]=atoll(value3);
-		}
-		if(line==size+1)
-			maxWeight=atoll(value1);
+	if(status == LOAD_NO_MEMORY){
+		fprintf(stderr,"\nOut of memory!!\n");
+		return false;
+	}
+	if(status != LOAD_OK){ // id fora de ordem ou arquivo truncado
+		fprintf(stderr,"\nERROR! Invalid knapsack file, aborting!! (%s)\n", fileName);
+		return false;
+	}
+	size = itens.n;
+	return true;
+}
+
+// Coleta recursivamente os test.in abaixo de dir, em ordem alfabética
+void collectInstances(const char* dir, std::vector<std::string> &paths){
+	std::error_code ec;
+	for(std::filesystem::recursive_directory_iterator itDir(dir, ec), end; !ec && itDir != end; itDir.increment(ec)){
+		if(itDir->is_regular_file(ec) && itDir->path().filename() == "test.in")
+			paths.push_back(itDir->path().string());
+	}
+	if(ec) fprintf(stderr,"\nFail to list directory!! (%s: %s)\n", dir, ec.message().c_str());
+	std::sort(paths.begin(), paths.end());
+}
+
+// Lê um caminho por linha (ignora linhas vazias e comentários iniciados por #)
+void readManifest(FILE *stream, std::vector<std::string> &paths){
+	char s[4096];
+	while(fgets(s, sizeof(s), stream)){
+		size_t len = strlen(s);
+		while(len > 0 && (s[len-1] == '\n' || s[len-1] == '\r')) s[--len] = '\0';
+		if(len == 0 || s[0] == '#') continue;
+		paths.push_back(s);
 	}
 }
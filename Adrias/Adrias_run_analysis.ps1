@@ -1,6 +1,11 @@
 # Compila e executa a análise para todas as instâncias.
 # Uso: pode ser executado de qualquer pasta; caminhos são relativos a este script.
 # Requisitos: PowerShell 5+ e g++ no PATH.
+# -Resume: continua uma varredura interrompida a partir dos diários resultados.journal.<k>
+# (com o mesmo número de processos); sem ele, os diários são recomeçados.
+# $env:KNAPSA_PROFILE: perfil de parâmetros do SA por classe (knapsack_tune); vazio = sem.
+
+param([switch]$Resume)
 
 $ErrorActionPreference = 'Stop'
 
@@ -13,62 +18,67 @@ $exe       = Join-Path $rootDir 'knapSA.exe'
 $results   = Join-Path $rootDir 'resultados.csv'
 $instancesRoot = Join-Path $rootDir 'problemInstances'
 
-# Compila com otimização e C++11; executável no diretório raiz do repositório
-& g++ $src -o $exe -O3 -std=c++11
+# Compila com otimização e C++17 (std::filesystem no modo lote; -march=native liga os kernels
+# AVX2/AVX-512 da avaliação e da DP); executável no diretório raiz do repositório
+& g++ $src -o $exe -O3 -march=native -std=c++17 -pthread
 if ($LASTEXITCODE -ne 0) {
     Write-Error 'Falha na compilação.'
     exit 1
 }
 
-# Cria/limpa o arquivo de resultados com cabeçalho CSV
-"instancia,lucro_guloso,lucro_sa,tempo_guloso_ms,tempo_sa_ms,tempo_total_ms" | Set-Content -Encoding ASCII $results
+# Diários das fatias (um por processo): cada instância concluída é gravada na hora
+$journalBase = Join-Path $rootDir 'resultados.journal'
+if (-not $Resume) {
+    Get-ChildItem -Path "$journalBase.*" -ErrorAction SilentlyContinue | Remove-Item -Force
+}
 
 # Encontra todas as instâncias test.in dentro de problemInstances
 $instances = Get-ChildItem -Path $instancesRoot -Recurse -File -Filter 'test.in' | Sort-Object FullName
 
 if ($instances.Count -eq 0) {
     Write-Warning 'Nenhuma instância encontrada em problemInstances.'
+    exit 0
 }
 
-# Execução paralela controlada
+# Execução paralela: em vez de um processo por instância, a lista ordenada é dividida
+# em fatias contíguas e cada job resolve uma fatia inteira em um único processo
+# (modo lote, manifesto via stdin), gravando no diário da fatia. Ao final os diários
+# são juntados no CSV (knapSA --merge), em ordem alfabética de instância.
 $maxParallel = [math]::Max(1, [int]$env:NUMBER_OF_PROCESSORS)
-Write-Host "Executando com até $maxParallel tarefas em paralelo."
+$chunkSize = [math]::Ceiling($instances.Count / $maxParallel)
+Write-Host "Executando $($instances.Count) instâncias em até $maxParallel processos."
 
 $jobs = @()
-
-function Flush-CompletedJobs {
-    param([string]$resultsPath)
-    $completed = $jobs | Where-Object { $_.State -ne 'Running' }
-    foreach ($j in $completed) {
-        try {
-            $out = Receive-Job $j -Keep
-            if ($out) { $out | Add-Content -Encoding ASCII $resultsPath }
-        } catch {
-            Write-Warning "Falha ao receber resultado do job Id=$($j.Id): $($_.Exception.Message)"
-        } finally {
-            Remove-Job $j -Force | Out-Null
-            $script:jobs = $jobs | Where-Object { $_.Id -ne $j.Id }
-        }
-    }
+$journals = @()
+$slice = 0
+for ($start = 0; $start -lt $instances.Count; $start += $chunkSize) {
+    $end = [math]::Min($start + $chunkSize, $instances.Count) - 1
+    $paths = @($instances[$start..$end] | ForEach-Object { $_.FullName })
+    $journal = "$journalBase.$slice"
+    $journals += $journal
+    $slice++
+    $runArgs = @('-', '--journal', $journal)
+    if ($Resume) { $runArgs += '--resume' }
+    if ($env:KNAPSA_PROFILE) { $runArgs += @('--profile', $env:KNAPSA_PROFILE) }
+    $jobs += Start-Job -ScriptBlock {
+        param($exePath, $filePaths, $exeArgs)
+        $filePaths | & $exePath @exeArgs | Out-Null
+    } -ArgumentList $exe, (,$paths), (,$runArgs)
 }
 
-foreach ($inst in $instances) {
-    while ( ($jobs | Where-Object { $_.State -eq 'Running' }).Count -ge $maxParallel ) {
-        Start-Sleep -Milliseconds 150
-        Flush-CompletedJobs -resultsPath $results
+foreach ($job in $jobs) {
+    try {
+        Receive-Job $job -Wait | Out-Null
+    } catch {
+        Write-Warning "Falha no job Id=$($job.Id) (as instâncias já concluídas estão no diário): $($_.Exception.Message)"
+    } finally {
+        Remove-Job $job -Force | Out-Null
     }
-
-    Write-Host "Enfileirando: $($inst.FullName)"
-    $job = Start-Job -ScriptBlock {
-        param($exePath, $filePath)
-        & $exePath $filePath
-    } -ArgumentList $exe, $inst.FullName
-    $jobs += $job
 }
 
-while ($jobs.Count -gt 0) {
-    Start-Sleep -Milliseconds 200
-    Flush-CompletedJobs -resultsPath $results
-}
+# resultados.csv a partir dos diários: cabeçalho + uma linha por instância concluída
+$header = "instancia,lucro_guloso,lucro_sa,tempo_guloso_ms,tempo_sa_ms,tempo_total_ms"
+$merged = & $exe '--merge' @journals
+@($header) + @($merged) | Set-Content -Encoding ASCII $results
 
 Write-Host "Análise concluída. Resultados salvos em $results"
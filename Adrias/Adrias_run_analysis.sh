@@ -1,20 +1,65 @@
 #!/usr/bin/env bash
 set -euo pipefail
 
-# Compila o executável com otimização
-if ! g++ Adrias_knapSA.cpp -o knapSA -O3 -std=c++11; then
+# Uso: Adrias_run_analysis.sh [--resume]
+#   --resume: continua a varredura interrompida a partir de resultados.journal
+#   (sem ele, o diário é recomeçado). Variáveis: KNAPSA_CACHE (arquivo de cache;
+#   sem ela, sem cache), KNAPSA_TIMEOUT_MS (prazo por instância; 0 = sem) e KNAPSA_PROFILE
+#   (perfil de parâmetros do SA por classe gerado pelo knapsack_tune; vazio = sem).
+RESUME=0
+if [ "${1:-}" = "--resume" ]; then
+  RESUME=1
+fi
+
+# Caminhos relativos a este script (pode ser executado de qualquer pasta)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+cd "$ROOT_DIR"
+
+# Compila o executável com otimização (C++17: std::filesystem no modo lote; -march=native
+# liga os kernels AVX2/AVX-512 da avaliação e da DP)
+if ! g++ "$SCRIPT_DIR/Adrias_knapSA.cpp" -o knapSA -O3 -march=native -std=c++17 -pthread; then
   echo "Falha na compilação" >&2
   exit 1
 fi
 
-# Cria/limpa arquivo de resultados e adiciona cabeçalho (6 colunas)
-echo "instancia,lucro_guloso,lucro_sa,tempo_guloso_ms,tempo_sa_ms,tempo_total_ms" > resultados.csv
+# Diário da varredura: cada instância concluída é gravada na hora em resultados.journal,
+# então uma interrupção não perde o que já foi resolvido (--resume continua dele)
+JOURNAL=resultados.journal
+if [ "$RESUME" -eq 0 ]; then
+  rm -f "$JOURNAL"
+fi
+
+# Cache de resultados só quando KNAPSA_CACHE é dado: instâncias já resolvidas com a mesma
+# versão/parâmetros/semente saem do cache sem rodar o SA, com os tempos da execução
+# original, e esta análise mede tempos
+CACHE="${KNAPSA_CACHE:-}"
+extra_args=()
+if [ -n "$CACHE" ]; then
+  extra_args+=(--cache "$CACHE")
+fi
+if [ "${KNAPSA_TIMEOUT_MS:-0}" != "0" ]; then
+  extra_args+=(--instance-timeout-ms "$KNAPSA_TIMEOUT_MS")
+fi
+if [ -n "${KNAPSA_PROFILE:-}" ]; then
+  extra_args+=(--profile "$KNAPSA_PROFILE")
+fi
+if [ "$RESUME" -eq 1 ]; then
+  extra_args+=(--resume)
+fi
+
+# Modo lote: um único processo resolve todas as instâncias (ordem alfabética);
+# instâncias ilegíveis, com erro ou fora do prazo são puladas (stderr e diário)
+# sem interromper a varredura.
+echo "Processando instâncias de problemInstances/ ..."
+status=0
+./knapSA problemInstances --journal "$JOURNAL" ${extra_args[@]+"${extra_args[@]}"} > /dev/null || status=$?
 
-# Encontra todas as instâncias e executa em lote
-# Usa IFS nulo e read -r para lidar com espaços no caminho
-while IFS= read -r -d '' file; do
-  echo "Processando: $file"
-  ./knapSA "$file" >> resultados.csv
-done < <(find problemInstances -type f -name 'test.in' -print0 | sort -z)
+# resultados.csv é gerado do diário ao final: cabeçalho (6 colunas) + uma linha por instância
+{
+  echo "instancia,lucro_guloso,lucro_sa,tempo_guloso_ms,tempo_sa_ms,tempo_total_ms"
+  ./knapSA --merge "$JOURNAL" || status=$?
+} > resultados.csv
 
 echo "Análise concluída. Resultados salvos em resultados.csv"
+exit $status
@@ -3,187 +3,146 @@
 #include <filesystem>
 #include <fstream>
 #include <chrono>
-#include <random>
+#include <cmath>
 #include <algorithm>
 #include <numeric>
 #include <cstring>
 #include <cstdlib>
+#include <mutex>
+#include "../common/itemStore.h"
+#include "../common/solution.h"
+#include "../common/greedy.h"
+#include "../common/workPool.h"
+#include "../common/instanceReader.h"
+#include "../common/random.h"
+#include "../common/acceptance.h"
+#include "../common/calibration.h"
 
 namespace fs = std::filesystem;
 
-// Estrutura para representar um item com suas propriedades
-struct Item {
-    int id;
-    long long profit;
-    long long weight;
-    double ratio; // razão lucro/peso
-    
-    Item(int i, long long p, long long w) : id(i), profit(p), weight(w) {
-        ratio = (w > 0) ? static_cast<double>(p) / static_cast<double>(w) : 0.0;
-    }
+/**
+ * Contexto de resolução de uma instância (reentrante): dados da instância e RNG
+ * próprios, de modo que várias instâncias possam ser resolvidas em paralelo
+ */
+struct SolverContext {
+    ItemStore itens;       // colunas contíguas itens.profit[i] / itens.weight[i]
+    int size = -1;
+    long long maxWeight = -1;
+    Rng rng;               // gerador xoshiro256++ (semeado por instância)
+    MetropolisThresholds metropolis; // limiares ln(u) pré-calculados em bloco
+    bool autoTemp = true;  // --temp auto: temperaturas calibradas pela instância
 };
 
-// Variáveis globais para os dados da instância
-std::vector<std::vector<long long>> itens;
-int size = -1;
-long long maxWeight = -1;
-
-// Gerador de números aleatórios global
-std::mt19937 rng(std::random_device{}());
-
 /**
  * Lê um arquivo de instância do problema da mochila
  * Formato: primeira linha = número de itens, linhas seguintes = id lucro peso, última linha = capacidade
+ * O arquivo é mapeado em memória e lido pelo scanner de common/instanceReader.h
  */
-bool readFile(const std::string& fileName) {
-    std::ifstream file(fileName);
-    if (!file.is_open()) {
-        std::cerr << "Erro ao abrir arquivo: " << fileName << std::endl;
-        return false;
-    }
-    
-    std::string line;
-    int lineNum = 0;
+bool readFile(SolverContext& ctx, const std::string& fileName) {
+    LoadDiag diag;
+    LoadStatus status = loadInstance(fileName.c_str(), ctx.itens, ctx.maxWeight, &diag);
     
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        
-        // Remove carriage return se presente
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
-        }
-        
-        std::istringstream iss(line);
-        
-        if (lineNum == 0) {
-            // Primeira linha: número de itens
-            iss >> size;
-            itens.clear();
-            itens.resize(size, std::vector<long long>(2));
-        }
-        else if (lineNum <= size) {
-            // Linhas dos itens: id lucro peso
-            int id;
-            long long profit, weight;
-            iss >> id >> profit >> weight;
-            
-            if (id != lineNum - 1) {
-                std::cerr << "Erro: ID inválido no arquivo. Esperado: " << (lineNum-1) << ", encontrado: " << id << std::endl;
-                return false;
-            }
-            
-            itens[id][0] = profit; // lucro
-            itens[id][1] = weight; // peso
-        }
-        else if (lineNum == size + 1) {
-            // Última linha: capacidade da mochila
-            iss >> maxWeight;
-        }
-        
-        lineNum++;
+    switch (status) {
+    case LOAD_OK:
+        ctx.size = ctx.itens.n; // ordem por razão calculada no primeiro uso (ratioOrder)
+        return true;
+    case LOAD_OPEN_FAILED:
+        std::cerr << "Erro ao abrir arquivo: " << fileName << std::endl;
+        break;
+    case LOAD_NO_MEMORY:
+        std::cerr << "Erro: memória insuficiente para os itens de " << fileName << std::endl;
+        break;
+    case LOAD_INVALID_ID:
+        std::cerr << "Erro: ID inválido no arquivo. Esperado: " << diag.expectedId << ", encontrado: " << diag.foundId << std::endl;
+        break;
+    default:
+        std::cerr << "Erro: arquivo de instância malformado: " << fileName << std::endl;
+        break;
     }
-    
-    file.close();
-    return true;
+    return false;
 }
 
 /**
  * Calcula o lucro total de uma solução
  * Retorna -1 se a solução for inválida (excede capacidade)
  */
-long long calculateSolProfit(const std::vector<bool>& sol) {
+long long calculateSolProfit(const SolverContext& ctx, const Solution& sol) {
     long long profit = 0;
     long long weight = 0;
     
-    for (int i = 0; i < size; i++) {
-        if (sol[i]) {
-            profit += itens[i][0]; // lucro
-            weight += itens[i][1]; // peso
-        }
-    }
+    // Colunas de lucro/peso mascaradas pelos bits da solução
+    solutionTotals(ctx.itens, sol, profit, weight);
     
-    return (weight > maxWeight) ? -1 : profit;
+    return (weight > ctx.maxWeight) ? -1 : profit;
 }
 
 /**
  * Implementação da Busca Gulosa
- * Ordena itens por razão lucro/peso (decrescente) e seleciona enquanto couber
+ * Seleciona por razão lucro/peso decrescente enquanto couber (common/greedy.h): o item
+ * crítico é achado por seleção e só os itens seguintes que ainda cabem são ordenados
  */
-long long greedy_search() {
-    // Cria vetor de itens com razões calculadas
-    std::vector<Item> items;
-    items.reserve(size);
-    
-    for (int i = 0; i < size; i++) {
-        items.emplace_back(i, itens[i][0], itens[i][1]);
-    }
-    
-    // Ordena por razão lucro/peso (decrescente)
-    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
-        if (a.ratio == b.ratio) {
-            // Critério de desempate: maior lucro primeiro, depois menor peso
-            if (a.profit == b.profit) {
-                return a.weight < b.weight;
-            }
-            return a.profit > b.profit;
-        }
-        return a.ratio > b.ratio;
-    });
-    
-    // Constrói a solução gulosa
-    std::vector<bool> solution(size, false);
-    long long remainingCapacity = maxWeight;
-    
-    for (const auto& item : items) {
-        if (item.weight <= remainingCapacity) {
-            solution[item.id] = true;
-            remainingCapacity -= item.weight;
-        }
-    }
-    
-    return calculateSolProfit(solution);
+long long greedy_search(const SolverContext& ctx) {
+    Solution solution(ctx.size);
+    greedySolve(ctx.itens, ctx.maxWeight, solution);
+    return calculateSolProfit(ctx, solution);
 }
 
 /**
  * Função de mutação para o Simulated Annealing
  * Realiza bit flip: inverte o valor de um índice aleatório
  */
-void tweak(std::vector<bool>& sol) {
-    if (size <= 0) return;
+void tweak(SolverContext& ctx, Solution& sol) {
+    if (ctx.size <= 0) return;
     
-    std::uniform_int_distribution<int> dist(0, size - 1);
-    int idx = dist(rng);
-    sol[idx] = !sol[idx];
+    int idx = static_cast<int>(ctx.rng.below(static_cast<uint32_t>(ctx.size)));
+    sol.flip(idx);
 }
 
 /**
  * Implementação do Simulated Annealing
  * Inicia com solução vazia e busca melhorias através de perturbações
+ *
+ * Com ctx.autoTemp as temperaturas inicial e final são calibradas pela instância
+ * (common/calibration.h): as únicas pioras viáveis deste vizinho são remoções, que
+ * custam o lucro do item, então T0/Tf são as temperaturas em que 80% / 0.1% dessas
+ * pioras seriam aceitas. alpha é recalculado para manter o mesmo número de iterações.
  */
-long long simulated_annealing() {
+long long simulated_annealing(SolverContext& ctx) {
     // Parâmetros do SA
     double temperature = 10000.0;    // temperatura inicial
     double min_temp = 0.01;          // temperatura mínima
     double alpha = 0.9995;           // taxa de resfriamento
     
+    if (ctx.autoTemp) {
+        double iterations = std::ceil(std::log(min_temp / temperature) / std::log(alpha));
+        std::vector<double> worsening;
+        worsening.reserve(ctx.size);
+        for (int i = 0; i < ctx.size; i++) {
+            if (ctx.itens.profit[i] > 0) worsening.push_back(static_cast<double>(ctx.itens.profit[i]));
+        }
+        TemperatureSchedule schedule = calibrateSchedule(worsening);
+        if (schedule.valid()) {
+            temperature = schedule.initial;
+            min_temp = schedule.final;
+            alpha = std::pow(min_temp / temperature, 1.0 / iterations);
+        }
+    }
+    
     // Inicialização: solução vazia (mochila vazia)
-    std::vector<bool> currentSol(size, false);
-    std::vector<bool> bestSol(size, false);
-    std::vector<bool> neighborSol(size);
+    Solution currentSol(ctx.size);
+    Solution bestSol(ctx.size);
+    Solution neighborSol(ctx.size);
     
     long long currentProfit = 0;  // solução vazia tem lucro 0
     long long bestProfit = 0;     // melhor solução inicial também é 0
     
-    // Distribuição uniforme para critério de aceitação
-    std::uniform_real_distribution<double> uniform(0.0, 1.0);
-    
     // Loop principal do Simulated Annealing
     while (temperature > min_temp) {
         // Gera solução vizinha
-        neighborSol = currentSol;
-        tweak(neighborSol);
+        neighborSol.copyFrom(currentSol); // cópia de size/64 palavras
+        tweak(ctx, neighborSol);
         
-        long long neighborProfit = calculateSolProfit(neighborSol);
+        long long neighborProfit = calculateSolProfit(ctx, neighborSol);
         
         // Se a solução vizinha é inválida, trata como lucro muito baixo
         long long evalNeighbor = (neighborProfit < 0) ? -1000000000LL : neighborProfit;
@@ -197,20 +156,20 @@ long long simulated_annealing() {
             // Solução melhor ou igual: aceita
             accept = true;
         } else {
-            // Solução pior: aceita com probabilidade exp(delta/temperature)
-            double acceptProb = std::exp(static_cast<double>(delta) / temperature);
-            accept = (uniform(rng) < acceptProb);
+            // Solução pior: aceita com probabilidade exp(delta/temperature),
+            // testada como delta >= temperature * ln(u) com ln(u) pré-calculado
+            accept = ctx.metropolis.accept(ctx.rng, static_cast<double>(delta), temperature);
         }
         
         if (accept) {
-            currentSol = neighborSol;
+            currentSol.copyFrom(neighborSol);
             currentProfit = neighborProfit;
         }
         
         // Atualiza a melhor solução encontrada (apenas se for válida)
         if (currentProfit > bestProfit && currentProfit >= 0) {
             bestProfit = currentProfit;
-            bestSol = currentSol;
+            bestSol.copyFrom(currentSol);
         }
         
         // Resfriamento
@@ -220,16 +179,86 @@ long long simulated_annealing() {
     return bestProfit;
 }
 
+/**
+ * Resultado de uma instância; as linhas do CSV são emitidas na ordem dos arquivos
+ */
+struct InstanceResult {
+    bool ok = false;
+    long long greedyProfit = 0;
+    long long saProfit = 0;
+    long long greedyMs = 0;
+    long long saMs = 0;
+};
+
+/**
+ * Resolve uma instância do início ao fim usando apenas o contexto recebido
+ */
+InstanceResult solveInstance(SolverContext& ctx, const fs::path& instancePath) {
+    InstanceResult res;
+    
+    // Lê a instância
+    if (!readFile(ctx, instancePath.string())) {
+        std::cerr << "Erro ao ler instância: " << instancePath << std::endl;
+        return res;
+    }
+    
+    // Executa Busca Gulosa e mede tempo
+    auto start = std::chrono::high_resolution_clock::now();
+    res.greedyProfit = greedy_search(ctx);
+    auto end = std::chrono::high_resolution_clock::now();
+    res.greedyMs = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    
+    // Executa Simulated Annealing e mede tempo
+    start = std::chrono::high_resolution_clock::now();
+    res.saProfit = simulated_annealing(ctx);
+    end = std::chrono::high_resolution_clock::now();
+    res.saMs = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    
+    // O bloco de itens fica no contexto: a próxima instância da thread o reaproveita
+    // (ItemStore::resize só realoca se ela for maior)
+    res.ok = true;
+    return res;
+}
+
 int main(int argc, char* argv[]) {
     // Verifica argumentos de linha de comando
-    if (argc != 3) {
-        std::cerr << "Uso: " << argv[0] << " <diretorio_de_instancias> <arquivo_saida.csv>" << std::endl;
-        std::cerr << "Exemplo: " << argv[0] << " ./problemInstances resultados.csv" << std::endl;
+    int threads = 1;
+    uint64_t seed = 42;
+    bool autoTemp = true;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            threads = std::atoi(arg.c_str() + 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            seed = std::strtoull(arg.c_str() + 7, nullptr, 10);
+        } else if ((arg == "--temp" && i + 1 < argc) || arg.rfind("--temp=", 0) == 0) {
+            std::string mode = (arg == "--temp") ? argv[++i] : arg.substr(7);
+            if (mode != "auto" && mode != "fixed") {
+                std::cerr << "Modo de temperatura desconhecido: " << mode << " (use auto | fixed)" << std::endl;
+                return 1;
+            }
+            autoTemp = (mode == "auto");
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 2) {
+        std::cerr << "Uso: " << argv[0] << " <diretorio_de_instancias> <arquivo_saida.csv> [--threads N] [--seed S] [--temp auto|fixed]" << std::endl;
+        std::cerr << "Exemplo: " << argv[0] << " ./problemInstances resultados.csv --threads 8" << std::endl;
+        std::cerr << "  --threads N   resolve N instâncias em paralelo (0 = todos os núcleos; padrão 1)" << std::endl;
+        std::cerr << "  --seed S      semente base; cada instância usa um fluxo derivado dela (padrão 42)" << std::endl;
+        std::cerr << "  --temp M      auto: temperaturas calibradas pelos lucros (padrão); fixed: 10000 -> 0.01" << std::endl;
         return 1;
     }
+    threads = resolveThreadCount(threads);
     
-    std::string instancesDir = argv[1];
-    std::string outputFile = argv[2];
+    std::string instancesDir = positional[0];
+    std::string outputFile = positional[1];
     
     // Verifica se o diretório existe
     if (!fs::exists(instancesDir) || !fs::is_directory(instancesDir)) {
@@ -263,46 +292,66 @@ int main(int argc, char* argv[]) {
     // Ordena os arquivos para processamento consistente
     std::sort(instanceFiles.begin(), instanceFiles.end());
     
-    std::cout << "Encontradas " << instanceFiles.size() << " instâncias para processar." << std::endl;
+    std::cout << "Encontradas " << instanceFiles.size() << " instâncias para processar"
+              << " (" << threads << " thread" << (threads > 1 ? "s" : "") << ")." << std::endl;
     
-    // Processa cada instância
+    // Escalonamento: instâncias maiores (arquivo maior ~ n maior) primeiro, empate pela ordem dos arquivos
+    std::vector<uintmax_t> fileBytes(instanceFiles.size(), 0);
     for (size_t i = 0; i < instanceFiles.size(); i++) {
-        const auto& instancePath = instanceFiles[i];
+        std::error_code ec;
+        uintmax_t b = fs::file_size(instanceFiles[i], ec);
+        fileBytes[i] = ec ? 0 : b;
+    }
+    std::vector<int> schedule(instanceFiles.size());
+    std::iota(schedule.begin(), schedule.end(), 0);
+    std::stable_sort(schedule.begin(), schedule.end(), [&](int a, int b) {
+        return fileBytes[a] > fileBytes[b];
+    });
+    
+    // Um contexto (dados + RNG) por thread
+    std::vector<SolverContext> contexts(threads);
+    for (auto& ctx : contexts) ctx.autoTemp = autoTemp;
+    
+    // Resultados chegam fora de ordem; as linhas são escritas assim que o prefixo está completo
+    std::vector<InstanceResult> results(instanceFiles.size());
+    std::vector<char> done(instanceFiles.size(), 0);
+    size_t nextRow = 0, finished = 0;
+    std::mutex outMutex;
+    
+    runWorkStealing(schedule, threads, [&](int idx, int thread) {
+        // Fluxo da instância derivado da semente e do índice: o resultado não depende
+        // da thread que a resolveu nem do número de threads
+        contexts[thread].rng.seed(streamSeed(seed, static_cast<uint64_t>(idx)));
+        contexts[thread].metropolis.reset();
+        InstanceResult res = solveInstance(contexts[thread], instanceFiles[idx]);
         
-        std::cout << "Processando (" << (i+1) << "/" << instanceFiles.size() << "): " 
-                  << instancePath << std::endl;
+        std::lock_guard<std::mutex> lk(outMutex);
+        results[idx] = res;
+        done[idx] = 1;
+        finished++;
+        std::cout << "Concluída (" << finished << "/" << instanceFiles.size() << "): "
+                  << instanceFiles[idx] << std::endl;
         
-        // Lê a instância
-        if (!readFile(instancePath.string())) {
-            std::cerr << "Erro ao ler instância: " << instancePath << std::endl;
-            continue;
+        // Escreve resultado no CSV, preservando a ordem dos arquivos
+        while (nextRow < instanceFiles.size() && done[nextRow]) {
+            const InstanceResult& r = results[nextRow];
+            if (r.ok) {
+                csvFile << instanceFiles[nextRow].string() << "," 
+                        << r.greedyProfit << "," 
+                        << r.saProfit << "," 
+                        << r.greedyMs << "," 
+                        << r.saMs << "\n";
+            }
+            nextRow++;
         }
-        
-        // Executa Busca Gulosa e mede tempo
-        auto start = std::chrono::high_resolution_clock::now();
-        long long greedyProfit = greedy_search();
-        auto end = std::chrono::high_resolution_clock::now();
-        auto greedyTime = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-        
-        // Executa Simulated Annealing e mede tempo
-        start = std::chrono::high_resolution_clock::now();
-        long long saProfit = simulated_annealing();
-        end = std::chrono::high_resolution_clock::now();
-        auto saTime = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-        
-        // Escreve resultado no CSV
-        csvFile << instancePath.string() << "," 
-                << greedyProfit << "," 
-                << saProfit << "," 
-                << greedyTime.count() << "," 
-                << saTime.count() << std::endl;
-        
-        // Libera memória (os vetores são automaticamente limpos na próxima iteração)
-        itens.clear();
-    }
+        csvFile.flush();
+    });
+    
+    // Todas as threads terminaram: libera os blocos de itens uma vez só
+    for (auto& ctx : contexts) ctx.itens.release();
     
     csvFile.close();
     std::cout << "Processamento concluído. Resultados salvos em: " << outputFile << std::endl;
     
     return 0;
-}
\ No newline at end of file
+}
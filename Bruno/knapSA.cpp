@@ -1,5 +1,9 @@
 // knapSA.cpp
-// Compile: g++ -O3 -std=c++11 knapSA.cpp -o knapSA
+// Compile: g++ -O3 -march=native -std=c++11 knapSA.cpp -o knapSA
+// Debug:   add -DKNAPSA_CHECK_EVAL to validate the incremental evaluator against full rescans
+//          add -DKNAPSA_EXACT_ACCEPT to draw each Metropolis threshold with std::log (validation)
+//          add -DKNAPSA_FIXED_TEMP to use the old fixed schedule (T0 = 1000, alpha = 0.995)
+//          add -DKNAPSA_NO_LOCAL_SEARCH to start SA from the plain greedy solution
 
 #include <cstdio>
 #include <cstdlib>
@@ -10,30 +14,90 @@
 #include <utility>
 #include <algorithm>
 #include <limits>
+#include "../common/itemStore.h"
+#include "../common/solution.h"
+#include "../common/greedy.h"
+#include "../common/localSearch.h"
+#include "../common/instanceReader.h"
+#include "../common/random.h"
+#include "../common/acceptance.h"
+#include "../common/calibration.h"
 
 using ll = long long;
 
-ll calculateSolProfitBool(const std::vector<char> &sol); // returns -1 if infeasible? we'll use ll and check weight separately
-double calculatePenalizedScore(const std::vector<char> &sol, double penalty_coef, ll maxWeight);
-void tweak(std::vector<char> &sol);
+ll calculateSolProfitBool(const Solution &sol); // returns -1 if infeasible? we'll use ll and check weight separately
+double calculatePenalizedScore(const Solution &sol, double penalty_coef, ll maxWeight);
+void tweak(int &i, int &j); // draws the flip indices (j = -1 for a single flip)
 void readFile(const char* fileName);
 
-// items: itens[i][0] = profit, itens[i][1] = weight
-ll **itens = nullptr;
+// items: itens.profit[i], itens.weight[i] (contiguous aligned columns)
+ItemStore itens;
 int sizeItems = -1;
 ll maxWeight = -1;
 
-// helper to copy
-static inline void copySol(std::vector<char> &dst, const std::vector<char> &src){
-    std::memcpy(dst.data(), src.data(), sizeof(char)*src.size());
-}
+// xoshiro256++ generator (common/random.h); seeded in main
+Rng rng;
+
+// Incremental evaluator: keeps the running profit, weight and penalized score of
+// one solution so a flip costs O(1) instead of two O(n) rescans.
+struct IncrementalEval {
+    Solution sol;
+    ll profit = 0;
+    ll weight = 0;
+    double penalty_coef = 0.0;
+
+    // full O(n) rebuild from a solution vector
+    void load(const Solution &s, double coef){
+        sol.copyFrom(s);
+        penalty_coef = coef;
+        solutionTotals(itens, sol, profit, weight);
+    }
+
+    // same formula as calculatePenalizedScore, from exact integer totals
+    double scoreOf(ll p, ll w) const {
+        long double overflow = 0.0L;
+        if(w > maxWeight) overflow = (long double)(w - maxWeight);
+        return (double)((long double)p - (long double)penalty_coef * overflow);
+    }
+    double score() const { return scoreOf(profit, weight); }
+
+    // profit/weight after flipping i (and j, if j >= 0), without touching sol
+    void peek(int i, int j, ll &p, ll &w) const {
+        p = profit; w = weight;
+        if(sol.get(i)){ p -= itens.profit[i]; w -= itens.weight[i]; }
+        else      { p += itens.profit[i]; w += itens.weight[i]; }
+        if(j >= 0){
+            if(sol.get(j)){ p -= itens.profit[j]; w -= itens.weight[j]; }
+            else      { p += itens.profit[j]; w += itens.weight[j]; }
+        }
+    }
+
+    void flip(int i){
+        if(sol.get(i)){ profit -= itens.profit[i]; weight -= itens.weight[i]; }
+        else      { profit += itens.profit[i]; weight += itens.weight[i]; }
+        sol.flip(i);
+    }
+
+    // debug: compare the running totals with an exact full rescan
+    bool checkExact() const {
+        ll p = 0, w = 0;
+        for(int i=0;i<sizeItems;i++){
+            if(sol.get(i)){ p += itens.profit[i]; w += itens.weight[i]; }
+        }
+        return p == profit && w == weight &&
+               score() == calculatePenalizedScore(sol, penalty_coef, maxWeight) &&
+               (w > maxWeight ? -1 : p) == calculateSolProfitBool(sol);
+    }
+};
 
 int main(int argc, char **argv){
     if(argc < 2){
-        std::fprintf(stderr, "Usage: %s <path/to/test.in>\n", argv[0]);
+        std::fprintf(stderr, "Usage: %s <path/to/test.in> [seed]\n", argv[0]);
         return 1;
     }
     const char *fileName = argv[1];
+    // optional seed for reproducible runs; defaults to the clock, as before
+    unsigned long long seed = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : (unsigned long long)time(NULL);
     readFile(fileName);
 
     if(sizeItems <= 0){
@@ -44,8 +108,8 @@ int main(int argc, char **argv){
     // compute some stats for penalty calculation
     long double totalProfit = 0.0L, totalWeight = 0.0L;
     for(int i=0;i<sizeItems;i++){
-        totalProfit += (long double)itens[i][0];
-        totalWeight += (long double)itens[i][1];
+        totalProfit += (long double)itens.profit[i];
+        totalWeight += (long double)itens.weight[i];
     }
     long double avgProfitPerWeight = 1.0L;
     if(totalWeight > 0.0L) avgProfitPerWeight = totalProfit / totalWeight;
@@ -54,29 +118,24 @@ int main(int argc, char **argv){
     long double penalty_factor = 10.0L;
     double penalty_coef = (double)(avgProfitPerWeight * penalty_factor);
 
-    // -- GREEDY (profit/weight descending)
-    std::vector<std::pair<long double,int>> order; order.reserve(sizeItems);
-    for(int i=0;i<sizeItems;i++){
-        long double ratio = (long double)itens[i][0] / (long double)itens[i][1];
-        order.emplace_back(-ratio, i); // negative so std::sort ascending gives highest ratio first
-    }
-    std::sort(order.begin(), order.end());
-
-    std::vector<char> greedySol(sizeItems, 0);
-    long double curWeight = 0.0L;
-    for(size_t k=0;k<order.size();k++){
-        int idx = order[k].second;
-        if(curWeight + (long double)itens[idx][1] <= (long double)maxWeight){
-            greedySol[idx] = 1;
-            curWeight += (long double)itens[idx][1];
-        }
-    }
+    // -- GREEDY (profit/weight descending; critical item by selection, see common/greedy.h)
+    Solution greedySol(sizeItems);
+    greedySolve(itens, maxWeight, greedySol);
 
     ll greedyProfit = calculateSolProfitBool(greedySol);
     printf("best greedy sol: ");
-    for(int i=0;i<sizeItems;i++) printf("%d", greedySol[i]?1:0);
+    for(int i=0;i<sizeItems;i++) printf("%d", greedySol.get(i)?1:0);
     printf("\nGreedy: %lld\n", greedyProfit);
 
+    // warm start: best-improvement 1-1 swaps + fill on top of the greedy (common/localSearch.h)
+    Solution startSol;
+    startSol.copyFrom(greedySol);
+#ifndef KNAPSA_NO_LOCAL_SEARCH
+    LocalSearchScratch lsScratch;
+    LocalSearchResult ls = improveBySwaps(itens, maxWeight, startSol, lsScratch);
+    printf("Local search: %lld (%d swaps)\n", ls.profit, ls.swaps);
+#endif
+
     // ---------- Simulated Annealing with penalization ----------
     // SA parameters (tune as needed)
     double T = 1000.0;
@@ -85,37 +144,69 @@ int main(int argc, char **argv){
     if(sizeItems > 800) maxIter = 300000;
     if(sizeItems > 1000) maxIter = 400000;
 
-    std::srand((unsigned)time(NULL));
+    // initial solution for SA: greedy (+ local search)
+    IncrementalEval current;
+    current.load(startSol, penalty_coef);
+
+#ifndef KNAPSA_FIXED_TEMP
+    // calibrate T0/Tf from the worsening deltas of random moves around the start
+    // (30% -> 0.1% acceptance: the start is already good, so reheat only enough to
+    // leave its local optimum) and cool so that T reaches Tf at maxIter; a fixed
+    // T0 means nothing across capacity classes (deltas from hundreds to millions)
+    {
+        rng.seed(streamSeed(seed, 0xCA1B)); // own stream: the SA stream is unchanged
+        int samples = std::min(4000, 1000 + 2*sizeItems);
+        std::vector<double> worsening;
+        worsening.reserve(samples);
+        for(int k=0; k<samples; ++k){
+            int fi, fj;
+            tweak(fi, fj);
+            ll p, w;
+            current.peek(fi, fj, p, w);
+            double delta = current.scoreOf(p, w) - current.score();
+            if(delta < 0.0) worsening.push_back(-delta);
+        }
+        TemperatureTargets targets;
+        targets.initialAcceptance = 0.3;
+        TemperatureSchedule schedule = calibrateSchedule(worsening, targets);
+        if(schedule.valid()){
+            T = schedule.initial;
+            alpha = std::pow(schedule.final / schedule.initial, 1.0 / maxIter);
+        }
+    }
+#endif
 
-    // initial solution for SA: use greedySol
-    std::vector<char> currentSol = greedySol;
-    std::vector<char> candidateSol(sizeItems);
-    std::vector<char> bestFeasibleSol = greedySol; // best feasible (valid) solution found
-    double currentScore = calculatePenalizedScore(currentSol, penalty_coef, maxWeight);
-    ll currentProfit = calculateSolProfitBool(currentSol);
+    rng.seed(seed);
+    MetropolisThresholds metropolis; // ln(u) drawn in blocks; accept iff delta >= T*ln(u)
+#ifdef KNAPSA_EXACT_ACCEPT
+    metropolis.exact = true;
+#endif
+    Solution bestFeasibleSol;
+    bestFeasibleSol.copyFrom(startSol); // best feasible (valid) solution found
+    double currentScore = current.score();
+    ll currentProfit = calculateSolProfitBool(current.sol);
     double bestScore = currentScore;
     ll bestFeasibleProfit = (currentProfit >= 0 ? currentProfit : -1);
     if(bestFeasibleProfit < 0) bestFeasibleProfit = -1;
 
     for(int iter=0; iter<maxIter; ++iter){
-        // generate neighbor
-        copySol(candidateSol, currentSol);
-        tweak(candidateSol);
+        // generate neighbor (evaluated in O(1), applied only if accepted)
+        int fi, fj;
+        tweak(fi, fj);
 
-        double candScore = calculatePenalizedScore(candidateSol, penalty_coef, maxWeight);
-        ll candProfit = calculateSolProfitBool(candidateSol);
+        ll candP, candW;
+        current.peek(fi, fj, candP, candW);
+        double candScore = current.scoreOf(candP, candW);
+        ll candProfit = (candW > maxWeight) ? -1 : candP;
 
         double delta = candScore - currentScore;
         bool accept = false;
         if(delta >= 0.0) accept = true;
-        else {
-            double p = exp(delta / T);
-            double u = (double)rand() / (double)RAND_MAX;
-            if(u < p) accept = true;
-        }
+        else accept = metropolis.accept(rng, delta, T); // same law as u < exp(delta/T)
 
         if(accept){
-            copySol(currentSol, candidateSol);
+            current.flip(fi);
+            if(fj >= 0) current.flip(fj);
             currentScore = candScore;
             currentProfit = candProfit;
             if(candScore > bestScore) bestScore = candScore;
@@ -123,50 +214,47 @@ int main(int argc, char **argv){
             if(candProfit >= 0){
                 if(bestFeasibleProfit < candProfit){
                     bestFeasibleProfit = candProfit;
-                    copySol(bestFeasibleSol, candidateSol);
+                    bestFeasibleSol.copyFrom(current.sol); // n/64 words
                 }
             }
         }
 
+#ifdef KNAPSA_CHECK_EVAL
+        if(!current.checkExact()){
+            std::fprintf(stderr, "incremental evaluation mismatch at iter %d\n", iter);
+            std::exit(1);
+        }
+#endif
+
         // cooling
         T *= alpha;
         if(T < 1e-12) T = 1e-12;
     }
 
     printf("best S.A sol: ");
-    for(int i=0;i<sizeItems;i++) printf("%d", bestFeasibleSol[i]?1:0);
+    for(int i=0;i<sizeItems;i++) printf("%d", bestFeasibleSol.get(i)?1:0);
     printf("\nS.A: %lld\n", bestFeasibleProfit >= 0 ? bestFeasibleProfit : 0LL);
 
     // cleanup
-    for(int i=0;i<sizeItems;i++) free(itens[i]);
-    free(itens);
+    itens.release();
     return 0;
 }
 
 // calculate profit if feasible, else return -1
-ll calculateSolProfitBool(const std::vector<char> &sol){
+ll calculateSolProfitBool(const Solution &sol){
     long long profit = 0;
     long long weight = 0;
-    for(int i=0;i<sizeItems;i++){
-        if(sol[i]){
-            profit += itens[i][0];
-            weight += itens[i][1];
-        }
-    }
+    solutionTotals(itens, sol, profit, weight); // profit/weight columns masked by the bits
     if(weight > maxWeight) return -1;
     return profit;
 }
 
 // penalized score: profit - penalty_coef * max(0, weight - maxWeight)
-double calculatePenalizedScore(const std::vector<char> &sol, double penalty_coef, ll maxWeight){
-    long double profit = 0.0L;
-    long double weight = 0.0L;
-    for(int i=0;i<sizeItems;i++){
-        if(sol[i]){
-            profit += (long double)itens[i][0];
-            weight += (long double)itens[i][1];
-        }
-    }
+double calculatePenalizedScore(const Solution &sol, double penalty_coef, ll maxWeight){
+    long long p = 0, w = 0;
+    solutionTotals(itens, sol, p, w); // exact integer sums, same as summing in long double
+    long double profit = (long double)p;
+    long double weight = (long double)w;
     long double overflow = 0.0L;
     if(weight > (long double)maxWeight) overflow = weight - (long double)maxWeight;
     long double score = profit - (long double)penalty_coef * overflow;
@@ -174,59 +262,37 @@ double calculatePenalizedScore(const std::vector<char> &sol, double penalty_coef
 }
 
 // simple mutation: flip 1 bit, small chance flip 2 bits
-void tweak(std::vector<char> &sol){
+// only draws the indices; the caller evaluates and applies the flips
+void tweak(int &i, int &j){
     int n = sizeItems;
-    int i = rand() % n;
-    sol[i] = !sol[i];
-    double r = (double)rand() / (double)RAND_MAX;
+    i = (int)rng.below((uint32_t)n); // unbiased, unlike rand() % n
+    j = -1;
+    double r = rng.uniform();
     if(r < 0.10){
-        int j = rand() % n;
+        j = (int)rng.below((uint32_t)n);
         if(j == i) j = (j + 1) % n;
-        sol[j] = !sol[j];
     }
 }
 
+// memory-mapped parse (common/instanceReader.h); fills itens (the ratio order is sorted on first use, in ratioOrder())
 void readFile(const char* fileName){
-    char s[1024];
-    FILE *stream = fopen(fileName, "r");
-    if(stream == NULL){
+    LoadDiag diag;
+    LoadStatus status = loadInstance(fileName, itens, maxWeight, &diag);
+    if(status == LOAD_OPEN_FAILED){
         std::fprintf(stderr, "\nFail to Open File!! (%s)\n", fileName);
         std::exit(1);
     }
-    int line = -1;
-    while(fgets(s, sizeof(s), stream)){
-        size_t len = strlen(s);
-        if(len > 0 && s[len-1] == '\n') s[len-1] = '\0';
-        if(len > 1 && s[len-2] == '\r') s[len-2] = '\0';
-
-        char* value1 = std::strtok(s, " ");
-        char* value2 = std::strtok(NULL, " ");
-        char* value3 = std::strtok(NULL, " ");
-        line++;
-
-        if(value1 == NULL) continue;
-        if(line == 0){
-            sizeItems = atoi(value1);
-            itens = (ll**) malloc(sizeof(ll*) * sizeItems);
-            for(int i=0;i<sizeItems;i++){
-                itens[i] = (ll*) malloc(sizeof(ll)*2);
-                itens[i][0] = itens[i][1] = 0;
-            }
-        }
-        if(line > 0 && line <= sizeItems){
-            int id = atoi(value1);
-            if(id != line - 1){
-                std::fprintf(stderr,"\nERROR! Invalid knapsack file, aborting!! read id=%d expected=%d\n", id, line-1);
-                std::exit(1);
-            }
-            long long p = atoll(value2);
-            long long w = atoll(value3);
-            itens[id][0] = p;
-            itens[id][1] = w;
-        }
-        if(line == sizeItems + 1){
-            maxWeight = atoll(value1);
-        }
+    if(status == LOAD_NO_MEMORY){
+        std::fprintf(stderr, "\nOut of memory!! (%s)\n", fileName);
+        std::exit(1);
+    }
+    if(status == LOAD_INVALID_ID){
+        std::fprintf(stderr,"\nERROR! Invalid knapsack file, aborting!! read id=%lld expected=%d\n", diag.foundId, diag.expectedId);
+        std::exit(1);
+    }
+    if(status != LOAD_OK){
+        std::fprintf(stderr,"\nERROR! Invalid knapsack file, aborting!! (%s)\n", fileName);
+        std::exit(1);
     }
-    fclose(stream);
+    sizeItems = itens.n;
 }
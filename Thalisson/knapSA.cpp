@@ -6,6 +6,11 @@
 #include <limits.h> // INT_MAX
 #include <float.h> //DBL_MAX
 #include <time.h> 
+#include "../common/itemStore.h" // colunas contíguas [profit], [weight] + ordem por razão
+#include "../common/greedy.h" // gulosa por item crítico (sem ordenar tudo)
+#include "../common/solution.h" // solução em bits (palavras de 64 bits)
+#include "../common/instanceReader.h" // leitura via mmap
+#include "../common/random.h" // gerador xoshiro256++ (substitui rand())
 //n_400_c_1000000_g_14_f_0.1_eps_0_s_100
 //n - number of itens
 //c - capacity
@@ -14,17 +19,18 @@
 //eps - influences in the calculation of profit and weight
 //s - numbers sampled between 1 and s
 
-long long int calculateSolProfit(bool *sol);//calculate the profit of a given solution - invalid solutions get -1
-void tweak(bool* sol);
+long long int calculateSolProfit(const Solution &sol);//calculate the profit of a given solution - invalid solutions get -1
+void tweak(Solution &sol);
 void readFile(const char* fileName);
 
-long long int **itens; int size=-1; long long int maxWeight=-1; //[profit, weight]
+ItemStore itens; int size=-1; long long int maxWeight=-1; //itens.profit[i], itens.weight[i]
+Rng rng; // gerador pseudo-aleatório do SA
 
 int main(const int argc, const char **inputFile){
 	char fileName[100]="";
 		
 	 if(argc < 2){ //verify if an argument was passed (the first argument in C is the name of the executable)
-	 	fprintf(stderr,"use: knapSA <input file>\n\n");
+	 	fprintf(stderr,"use: knapSA <input file> [seed]\n\n");
 	 	exit(1);
 	 }else
 	 	strcpy(fileName,inputFile[1]);//read filename from stdin
@@ -34,79 +40,32 @@ int main(const int argc, const char **inputFile){
 
 	readFile(fileName);
 
-	bool sol[size];
-	for(int i=0; i<size; i++)
-		sol[i]=false;
+	Solution sol(size);//all false
 
 	//Greedy
 	//implement greedy search based on ratio weight/profit, the smaller the better
 
-	// Estrutura para armazenar os itens junto com sua razão peso/lucro e índice original.
-	// Isso é necessário para ordenar os itens sem perder a referência ao seu índice original.
-	struct ItemInfo {
-		int id;
-		double ratio; // Razão
-	};
-
-	// Aloca dinamicamente um array de ItemInfo para armazenar as informações de cada item.
-	ItemInfo* itemRatios = (ItemInfo*)malloc(size * sizeof(ItemInfo));
-
-	// Calcula a razão peso/lucro para cada item e armazena junto com seu ID original.
-	// A razão é calculada como peso / lucro. Itens com lucro zero ou negativo são tratados para evitar divisão por zero
-	// ou para serem considerados menos desejáveis (razão alta).
-	for (int i = 0; i < size; i++) {
-		itemRatios[i].id = i;
-		if (itens[i][0] > 0) { // Se o lucro for positivo, calcula a razão peso/lucro.
-			itemRatios[i].ratio = (double)itens[i][1] / itens[i][0]; // peso / lucro
-		} else { // Se o lucro for zero ou negativo, atribui uma razão muito alta para que seja selecionado por último (ou nunca).
-			itemRatios[i].ratio = DBL_MAX; // DBL_MAX é um valor muito grande definido em <float.h>
-		}
-	}
-
-	// Ordena os itens com base na razão peso/lucro em ordem crescente (menor razão primeiro).
-	// Isso significa que itens com menor peso por unidade de lucro (ou maior lucro por unidade de peso) serão priorizados.
-	for (int i = 0; i < size - 1; i++) {
-		for (int j = i + 1; j < size; j++) {
-			if (itemRatios[i].ratio > itemRatios[j].ratio) {
-				ItemInfo temp = itemRatios[i];
-				itemRatios[i] = itemRatios[j];
-				itemRatios[j] = temp;
-			}
-		}
-	}
-
-	// Solução gulosa foi iniciada na linha 37 deste código onde nenhum item é selecionado inicialmente.
-	
-	// Aqui vamos definir e o peso atual da mochila.
-	long long int currentWeight = 0;
-
-	// Percorre os itens ordenados e os adiciona à mochila se houver capacidade.
-	for (int i = 0; i < size; i++) {
-		int itemId = itemRatios[i].id;
-		// Verifica se o item pode ser adicionado sem exceder a capacidade máxima da mochila.
-		if (currentWeight + itens[itemId][1] <= maxWeight) {
-			sol[itemId] = true; // Adiciona o item à solução.
-			currentWeight += itens[itemId][1]; // Atualiza o peso atual da mochila.
-		}
-	}
+	// Solução gulosa foi iniciada logo após a leitura (sol zerada), onde nenhum item é selecionado inicialmente.
+	// A gulosa (common/greedy.h) acha o item crítico por seleção, sem ordenar todos os itens,
+	// e só ordena os itens seguintes que ainda cabem na mochila.
+	greedySolve(itens, maxWeight, sol);
 
 	// printf("best greedy sol: ");  //Não sei se isso aqui é interessante, portanto vou deixar comentado para o print do resultado ficar mais limpo
 	// for(int i=0;i<size;i++)//print all sol positions
-	// 	printf("%d", sol[i]);
+	// 	printf("%d", sol.get(i));
 
 	printf("\nGreedy: %lld\n",calculateSolProfit(sol));
 	
-	for(int i=0; i<size; i++)//reset sol
-		sol[i]=false;
+	sol.clear();//reset sol
 
-	bool bestSol[size];
-	memcpy(bestSol,sol,sizeof(bool)*size);//copy sol to new sol
+	Solution bestSol;
+	bestSol.copyFrom(sol);//copy sol to new sol
 
 	// 	S.A.
 	//implement simulated annealing
 	
-	// Inicializa o gerador de números pseudo-aleatórios com a hora atual.
-	srand(time(NULL));
+	// Inicializa o gerador com a semente opcional (segundo argumento) ou com a hora atual.
+	rng.seed(argc > 2 ? strtoull(inputFile[2], NULL, 10) : (unsigned long long)time(NULL));
 
 	double t = 1000.0; // t: temperatura, inicialmente um número alto
 	double taxaResfriamento = 0.9; 	// Taxa de resfriamento para diminuir a temperatura
@@ -120,13 +79,14 @@ int main(const int argc, const char **inputFile){
 
 	long long int qualidadeBest = qualidadeS;
 
+	Solution R(size); // vizinho, reaproveitado em todas as iterações
+
 	// Loop principal do Simulated Annealing: repeat...until (Pseudocódigo do Luke 2015)
 	// A condição de parada será t <= 0 ou um limite de iterações.
 	while (t > 0 && iteracaoAtual < maxIteracoes) {
 		// S será sol
 		// R <- Tweak(Copy(S))
-		bool R[size];
-		memcpy(R, sol, sizeof(bool) * size); // Copia S para R
+		R.copyFrom(sol); // Copia S para R (size/64 palavras)
 		tweak(R); // Aplica a mutação (bit flip) na solução vizinha R
 
 		long long int qualidadeR = calculateSolProfit(R);
@@ -137,10 +97,10 @@ int main(const int argc, const char **inputFile){
 			long long int deltaQualidade = qualidadeR - qualidadeS;
 			
 			//Regra de metropolis
-			// rand() / RAND_MAX gera um número aleatório entre 0 e 1.
-			if (deltaQualidade > 0 || ( (double)rand() / RAND_MAX ) < exp((double)deltaQualidade / t)) {
+			// rng.uniform() gera um número aleatório em [0, 1).
+			if (deltaQualidade > 0 || rng.uniform() < exp((double)deltaQualidade / t)) {
 				// S <- R
-				memcpy(sol, R, sizeof(bool) * size);
+				sol.copyFrom(R);
 				qualidadeS = qualidadeR;
 			}
 		}
@@ -152,81 +112,49 @@ int main(const int argc, const char **inputFile){
 		// if Quality(S) > Quality(Best) then
 		if (qualidadeS > qualidadeBest) {
 			// Best <- S
-			memcpy(bestSol, sol, sizeof(bool) * size);
+			bestSol.copyFrom(sol);
 			qualidadeBest = qualidadeS;
 		}
 	}
 
     // printf("best S.A sol: "); //Comentei para uma saída mais limpa
     // for(int i=0;i<size;i++)//percorre todas as posições da sol
-    //     printf("%d", bestSol[i]);
+    //     printf("%d", bestSol.get(i));
 
     printf("\nS.A: %lld\n",calculateSolProfit(bestSol));
 
 }
 
-void tweak(bool *sol){
+void tweak(Solution &sol){
 	//implement
 	//bit flip mutation
 	// Seleciona um índice aleatório dentro do tamanho da solução (size).
-	// A função rand() é usada para gerar um número pseudo-aleatório.
-	// O operador % size garante que o índice esteja dentro dos limites válidos [0, size-1].
-	int itemParaFlip = rand() % size;
+	// rng.below(size) sorteia um índice uniforme em [0, size-1], sem o viés do rand() % size.
+	int itemParaFlip = (int)rng.below((uint32_t)size);
 
 	// Inverte o estado do item selecionado (se estava incluído, agora não está; e vice-versa).
-	sol[itemParaFlip] = !sol[itemParaFlip];
+	sol.flip(itemParaFlip);
 }
 
-long long int calculateSolProfit(bool *sol){//calculate the profit of a given solution - invalid solutions get -1
+long long int calculateSolProfit(const Solution &sol){//calculate the profit of a given solution - invalid solutions get -1
 	long long int profit=0;
 	long long int weight=0;
-	for(int i=0; i<size; i++){
-		if(sol[i]){
-			profit+=itens[i][0];//[profit, weight]
-			weight+=itens[i][1];
-		}
-	}
+	solutionTotals(itens, sol, profit, weight);//[profit], [weight] columns masked by the solution bits
 	if(weight>maxWeight)
 		profit=-1;//if invalid solution, invalid profit
 	return profit;
 }
 
 void readFile(const char* fileName){
-	char s[500];
-	FILE *stream = fopen(fileName, "r"); //read file (read-only permission)
-	if( stream == NULL ){ // if the file was not read, error
+	//the file is memory-mapped and parsed by common/instanceReader.h (no fgets/strtok/atoi)
+	LoadStatus status = loadInstance(fileName, itens, maxWeight);
+	if(status == LOAD_OPEN_FAILED){ // if the file was not read, error
 		fprintf(stderr,"\nFail to Open File!!\n");
 		exit(1);
 	}
-	int line=-1;
-	while(fgets(s,500,stream)){ //read every line (not larger than 500 chars) of the input
-		if(strlen(s)-1>0) //remove the last break line of the line
-			s[strlen(s)-1]='\0';
-		if(('\r'==s[strlen(s)-1]))//in some files there is a carriage return at the end, don't know why. This command removes it
-			s[strlen(s)-1]=0;
-		
-		char* value1 = strtok(s," "); //creating sub-strings separated by space
-		char* value2 = strtok(NULL," ");
-		char* value3 = strtok(NULL," ");
-		line++;
-		
-		if(line==0){//it is the number o items
-			size=atoi(value1);
-			itens=(long long int**)malloc(size * sizeof(long long int*));			
-			for (int i=0;i<size;i++)
-				itens[i] = (long long int*)malloc(2 * sizeof(long long int));//two collumns [profit, weight]
-		}
-		
-		if(line>0 && line<size+1){//descriptions of the itens [id, profit, weight]
-			int id=atoi(value1);
-			if(id!=line-1){
-				fprintf(stderr,"\nERROR! Invalid knapsack file, aborting!!\n");
-				exit(1);
-			}
-			itens[id][0]=atoll(value2);
-			itens[id][1]=atoll(value3);
-		}
-		if(line==size+1)
-			maxWeight=atoll(value1);
+	if(status != LOAD_OK){ //invalid id, truncated file or out of memory
+		fprintf(stderr,"\nERROR! Invalid knapsack file, aborting!!\n");
+		exit(1);
 	}
-}
\ No newline at end of file
+	size=itens.n;
+}
@@ -12,8 +12,9 @@ RESULTS_DIR="individual_results"
 
 # --- Compilação ---
 echo "Compilando o arquivo C++: $SOURCE_FILE..."
-# -O3 para otimização e -std=c++11 para garantir compatibilidade
-g++ -std=c++11 -O3 "$SOURCE_FILE" -o "$EXECUTABLE"
+# -O3 para otimização, -march=native para os kernels AVX2/AVX-512 de common/solution.h
+# e -std=c++11 para garantir compatibilidade
+g++ -std=c++11 -O3 -march=native "$SOURCE_FILE" -o "$EXECUTABLE"
 
 # Verifica se a compilação foi bem-sucedida
 if [ $? -ne 0 ]; then
@@ -0,0 +1,65 @@
+#ifndef KNAPSACK_ACCEPTANCE_H
+#define KNAPSACK_ACCEPTANCE_H
+
+// Critério de Metropolis sem função transcendental por movimento.
+// Aceitar uma piora delta < 0 com probabilidade exp(delta/T) equivale a
+// delta >= T * ln(u), u ~ U(0,1]. Como ln(u) não depende de T, os valores ln(u)
+// são gerados em blocos (BATCH uniformes + um log vetorizável sobre o bloco) e
+// cada teste vira uma multiplicação e uma comparação, em qualquer temperatura.
+//
+// O modo exato (exact = true) chama std::log a cada teste, consumindo o gerador
+// um valor por vez, como antes; serve para validar o modo em bloco.
+
+#include <stdint.h>
+#include <string.h> // memcpy
+#include <cmath>
+#include "random.h"
+
+// ln(x) para x em (0, 1], sem chamadas à libm (o laço vetoriza com -O3).
+// x = m * 2^e com m em [sqrt(1/2), sqrt(2)); ln(m) = 2*atanh(t), t = (m-1)/(m+1),
+// |t| < 0.172, série até t^11: erro relativo < 5.1e-11 (medido; pior caso em x = sqrt(1/2)),
+// bem abaixo do ruído do SA.
+inline void fastLogBatch(double *v, int count){
+	const double LN2 = 0.69314718055994530942;
+	for(int i=0; i<count; ++i){
+		uint64_t bits;
+		memcpy(&bits, &v[i], sizeof(bits));
+		// mantissa >= sqrt(2)-1 (bits 0x6A09E667F3BCD): usa expoente e+1 e m/2, sem desvio
+		uint64_t up = ((bits & 0x000FFFFFFFFFFFFFULL) >= 0x6A09E667F3BCDULL) ? 1 : 0;
+		double e = static_cast<double>(static_cast<int64_t>((bits >> 52) & 0x7FF) - 1023 + static_cast<int64_t>(up));
+		uint64_t mbits = (bits & 0x000FFFFFFFFFFFFFULL) | ((0x3FFULL - up) << 52); // m em [sqrt(1/2), sqrt(2))
+		double m;
+		memcpy(&m, &mbits, sizeof(m));
+		double t = (m - 1.0) / (m + 1.0), t2 = t * t;
+		double s = t * (2.0 + t2 * (2.0/3.0 + t2 * (2.0/5.0 + t2 * (2.0/7.0 + t2 * (2.0/9.0 + t2 * (2.0/11.0))))));
+		v[i] = e * LN2 + s;
+	}
+}
+
+struct MetropolisThresholds {
+	static const int BATCH = 256;
+	bool exact = false;  // true: std::log por teste (validação)
+	double logs[BATCH];  // ln(u) pré-calculados
+	int next = BATCH;
+
+	// Descarta o bloco atual (início de uma nova instância/cadeia: reprodutibilidade)
+	void reset(){ next = BATCH; }
+
+	// Limiar T * ln(u) para o próximo teste
+	double threshold(Rng &rng, double temperature){
+		if(exact) return temperature * std::log(rng.uniformOpen());
+		if(next == BATCH){
+			rng.fillUniformOpen(logs, BATCH);
+			fastLogBatch(logs, BATCH);
+			next = 0;
+		}
+		return temperature * logs[next++];
+	}
+
+	// Aceita a piora delta (< 0) na temperatura dada?
+	bool accept(Rng &rng, double delta, double temperature){
+		return delta >= threshold(rng, temperature);
+	}
+};
+
+#endif
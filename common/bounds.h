@@ -0,0 +1,98 @@
+#ifndef KNAPSACK_BOUNDS_H
+#define KNAPSACK_BOUNDS_H
+
+// Limites superiores da relaxação linear (Dantzig) e fixação de variáveis por limite.
+// Os itens são percorridos em razão lucro/peso decrescente, comparada de forma
+// exata por multiplicação cruzada em 128 bits (a razão em double pode inverter
+// itens com razões quase iguais, o que tornaria o limite inválido).
+// Os limites servem às rotinas exatas (DP, branch-and-bound), que precisam que
+// sejam limites de fato: um limite subestimado faria descartar o ótimo.
+
+#include <algorithm>
+#include <vector>
+#include "itemStore.h"
+#include "solution.h"
+
+// Resultado comum dos solvers exatos (DP, branch-and-bound)
+struct ExactResult {
+	long long profit = -1;     // melhor lucro encontrado (ótimo se optimal)
+	long long upperBound = -1; // limite superior provado
+	bool optimal = false;
+	int freeItems = 0;         // itens livres após a redução
+	long long reducedCapacity = 0;
+	long long nodes = 0;       // nós explorados (branch-and-bound)
+	bool cancelled = false;    // parou por CancelToken (prazo ou pedido externo)
+};
+
+// floor(rem * p / w) sem overflow (rem, p, w >= 0, w > 0)
+inline long long fractionalProfit(long long rem, long long p, long long w){
+	return static_cast<long long>(static_cast<__int128>(rem) * p / w);
+}
+
+// Ordem por razão e somas de prefixo: P[k]/W[k] = lucro/peso dos k primeiros da ordem
+struct RatioPrefix {
+	std::vector<int> order;      // itens por razão decrescente (exata)
+	std::vector<int> position;   // position[item] = índice em order
+	std::vector<long long> P, W;
+
+	void build(const ItemStore &it){
+		int n = it.n;
+		const int *sorted = it.ratioOrder(); // ordem exata, cacheada no ItemStore
+		order.assign(sorted, sorted + n);
+		const long long *pr = it.profit, *wt = it.weight;
+		position.resize(n);
+		P.resize(n + 1);
+		W.resize(n + 1);
+		P[0] = W[0] = 0;
+		for(int k=0; k<n; ++k){
+			position[order[k]] = k;
+			P[k+1] = P[k] + pr[order[k]];
+			W[k+1] = W[k] + wt[order[k]];
+		}
+	}
+
+	// Limite de Dantzig com capacidade cap sobre todos os itens, exceto a posição
+	// excluded da ordem (-1 = nenhum). cap < 0 devolve -1 (inviável).
+	long long dantzig(const ItemStore &it, long long cap, int excluded = -1) const {
+		if(cap < 0) return -1;
+		int n = static_cast<int>(order.size());
+		long long we = (excluded >= 0) ? it.weight[order[excluded]] : 0;
+		long long pe = (excluded >= 0) ? it.profit[order[excluded]] : 0;
+		auto weightOf = [&](int k){ return W[k] - ((excluded >= 0 && excluded < k) ? we : 0); };
+		// maior k com weightOf(k) <= cap (weightOf é não decrescente)
+		int lo = 0, hi = n;
+		while(lo < hi){
+			int mid = (lo + hi + 1) / 2;
+			if(weightOf(mid) <= cap) lo = mid; else hi = mid - 1;
+		}
+		int k = lo;
+		long long bound = P[k] - ((excluded >= 0 && excluded < k) ? pe : 0);
+		int next = (k == excluded) ? k + 1 : k;
+		if(next < n){
+			long long w = it.weight[order[next]];
+			if(w > 0) bound += fractionalProfit(cap - weightOf(k), it.profit[order[next]], w);
+		}
+		return bound;
+	}
+};
+
+// Fixação de variáveis (redução clássica por limite): com incumbente de lucro lb,
+// se forçar x_j = 1 leva a limite <= lb, nenhuma solução melhor que lb usa j
+// (fixed[j] = 0); se forçar x_j = 0 leva a limite <= lb, toda solução melhor usa j
+// (fixed[j] = 1). Demais itens ficam livres (-1): é o "núcleo" em torno do item
+// crítico. O ótimo é max(lb, ótimo do problema reduzido).
+inline void fixByBounds(const ItemStore &it, const RatioPrefix &rp, long long capacity, long long lb, std::vector<signed char> &fixed){
+	int n = it.n;
+	fixed.assign(n, -1);
+	for(int k=0; k<n; ++k){
+		int j = rp.order[k];
+		long long wj = it.weight[j], pj = it.profit[j];
+		if(wj > capacity){ fixed[j] = 0; continue; }
+		long long upIn = pj + rp.dantzig(it, capacity - wj, k);
+		if(upIn <= lb){ fixed[j] = 0; continue; }
+		long long upOut = rp.dantzig(it, capacity, k);
+		if(upOut <= lb) fixed[j] = 1;
+	}
+}
+
+#endif
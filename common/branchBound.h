@@ -0,0 +1,168 @@
+#ifndef KNAPSACK_BRANCH_BOUND_H
+#define KNAPSACK_BRANCH_BOUND_H
+
+// Branch-and-bound em profundidade (esquema de Horowitz–Sahni) para as instâncias
+// em que a DP sobre a capacidade não cabe (c=1e8, c=1e10).
+//
+// - Mesma redução da DP (common/reduction.h): a incumbente (gulosa ou SA) fixa os
+//   itens provados dentro/fora e os dominados; a busca percorre só o núcleo, que já
+//   vem em razão decrescente.
+// - Em cada nó: avança gulosamente colocando os itens que cabem até o item crítico
+//   b e poda com o limite U2 de Martello–Toth (máximo entre x_b = 0 e x_b = 1).
+// - Orçamento de nós e de tempo: ao esgotar, o limite superior global é o maior
+//   limite entre os ramos ainda não explorados da pilha, o que dá o gap de otimalidade.
+
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+#include "itemStore.h"
+#include "solution.h"
+#include "bounds.h"
+#include "reduction.h"
+#include "cancel.h"
+
+struct BBOptions {
+	long long maxNodes = 0;       // 0 = sem limite
+	long long timeLimitMs = 1000; // 0 = sem limite
+	CancelToken *cancel = nullptr; // consultado a cada 1024 nós, como o relógio
+	SharedBound *shared = nullptr; // incumbente de outros solvers (--portfolio): poda com ela e recebe as melhoras
+};
+
+// Itens livres em razão decrescente, com somas de prefixo
+struct BBInstance {
+	int m = 0;
+	std::vector<long long> p, w, FP, FW;
+
+	// Maior b em [j, m] com FW[b] - FW[j] <= cr (itens j..b-1 cabem em cr)
+	int breakItem(int j, long long cr) const {
+		int lo = j, hi = m;
+		long long limit = FW[j] + cr;
+		while(lo < hi){
+			int mid = (lo + hi + 1) / 2;
+			if(FW[mid] <= limit) lo = mid; else hi = mid - 1;
+		}
+		return lo;
+	}
+
+	// Limite U2 de Martello–Toth para o nó (itens j.. livres, capacidade cr, lucro cp)
+	long long bound(int j, long long cr, long long cp, int &b) const {
+		b = breakItem(j, cr);
+		long long fit = cp + FP[b] - FP[j];
+		if(b >= m) return fit;
+		long long r = cr - (FW[b] - FW[j]);
+		long long u0 = fit + ((b + 1 < m && w[b+1] > 0) ? fractionalProfit(r, p[b+1], w[b+1]) : 0);
+		if(b == j || w[b-1] == 0) // sem item anterior para ceder espaço: Dantzig
+			return std::max(u0, fit + fractionalProfit(r, p[b], w[b]));
+		// x_b = 1: retira (w_b - r) de capacidade dos itens anteriores, ao custo mínimo da razão de b-1
+		__int128 lost = (static_cast<__int128>(w[b] - r) * p[b-1] + w[b-1] - 1) / w[b-1];
+		long long u1 = fit + p[b] - static_cast<long long>(lost);
+		return std::max(u0, u1);
+	}
+};
+
+// Resolve a instância (it, capacity) por branch-and-bound a partir da incumbente.
+// out (opcional): recebe a melhor solução (a incumbente se não houver melhora).
+// Com opt.shared, a poda usa também o lucro publicado por outros solvers: optimal
+// prova que nenhuma solução passa de upperBound, e se profit < upperBound a solução
+// ótima é a que foi publicada em shared (a busca não a tem).
+inline ExactResult solveBranchAndBound(const ItemStore &it, long long capacity, const Solution &incumbent, long long incumbentProfit, const BBOptions &opt, Solution *out = nullptr){
+	ExactResult res;
+	res.profit = incumbentProfit;
+	if(out) out->copyFrom(incumbent);
+
+	ReducedProblem red;
+	reduceProblem(it, capacity, incumbentProfit, red);
+	res.freeItems = red.n();
+	res.reducedCapacity = red.capacity;
+	if(red.closed){ // nenhuma solução melhor que a incumbente
+		res.upperBound = incumbentProfit;
+		res.optimal = true;
+		return res;
+	}
+	const ItemStore &core = red.core; // já na ordem de razão exata
+	long long fixedProfit = red.fixedProfit, residual = red.capacity;
+
+	BBInstance bb;
+	bb.m = core.n;
+	int m = bb.m;
+	bb.p.resize(m); bb.w.resize(m); bb.FP.assign(m + 1, 0); bb.FW.assign(m + 1, 0);
+	for(int k=0; k<m; ++k){
+		bb.p[k] = core.profit[k];
+		bb.w[k] = core.weight[k];
+		bb.FP[k+1] = bb.FP[k] + bb.p[k];
+		bb.FW[k+1] = bb.FW[k] + bb.w[k];
+	}
+
+	// Busca: x[k] em 0/1, pilha dos itens colocados (backtrack = tirar o último)
+	long long best = incumbentProfit - fixedProfit; // só interessam soluções livres melhores que isso
+	long long found = best; // melhor solução livre da própria busca (bestX)
+	std::vector<signed char> x(m, 0), bestX;
+	std::vector<int> taken;
+	taken.reserve(m);
+	long long cp = 0, cr = residual;
+	int j = 0;
+	bool exhausted = false;
+	auto start = std::chrono::steady_clock::now();
+	for(;;){
+		bool descend = true;
+		if(j < m){
+			if((opt.maxNodes > 0 && res.nodes >= opt.maxNodes) ||
+			   (opt.timeLimitMs > 0 && (res.nodes & 1023) == 0 &&
+			    std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() >= opt.timeLimitMs)){
+				exhausted = true;
+				break;
+			}
+			if(opt.cancel && (res.nodes & 1023) == 0 && opt.cancel->cancelled()){
+				exhausted = res.cancelled = true;
+				break;
+			}
+			if(opt.shared && (res.nodes & 1023) == 0) best = std::max(best, opt.shared->load() - fixedProfit);
+			++res.nodes;
+			int b;
+			if(bb.bound(j, cr, cp, b) > best){
+				for(int k=j; k<b; ++k){ x[k] = 1; cp += bb.p[k]; cr -= bb.w[k]; taken.push_back(k); }
+				if(b < m){ x[b] = 0; j = b + 1; continue; }
+				j = m;
+			}else descend = false;
+		}
+		if(descend && cp > best){ // folha: todos os itens livres decididos
+			best = found = cp;
+			bestX = x;
+			if(opt.shared) opt.shared->offer(fixedProfit + cp);
+		}
+		if(taken.empty()) break; // árvore esgotada
+		int k = taken.back(); // ramo x_k = 0
+		taken.pop_back();
+		x[k] = 0; cp -= bb.p[k]; cr += bb.w[k];
+		j = k + 1;
+	}
+
+	if(!bestX.empty()){
+		res.profit = fixedProfit + found;
+		if(out){
+			Solution coreSol(m);
+			for(int k=0; k<m; ++k) if(bestX[k]) coreSol.set(k, true);
+			red.expand(coreSol, *out);
+		}
+	}
+	if(!exhausted){
+		res.optimal = true;
+		res.upperBound = std::max(res.profit, fixedProfit + best);
+		return res;
+	}
+
+	// Orçamento esgotado: maior limite entre o nó atual e os ramos x_k = 0 pendentes
+	int b;
+	long long open = bb.bound(j, cr, cp, b);
+	long long pcp = 0, pcr = residual;
+	for(int k=0; k<j && k<m; ++k){
+		if(x[k]){
+			open = std::max(open, bb.bound(k + 1, pcr, pcp, b));
+			pcp += bb.p[k]; pcr -= bb.w[k];
+		}
+	}
+	res.upperBound = std::max(std::max(res.profit, fixedProfit + best), fixedProfit + open);
+	return res;
+}
+
+#endif
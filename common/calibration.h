@@ -0,0 +1,57 @@
+#ifndef KNAPSACK_CALIBRATION_H
+#define KNAPSACK_CALIBRATION_H
+
+// Calibração das temperaturas do SA a partir de pioras amostradas.
+// Uma temperatura fixa (10000, 1000) não significa nada entre classes de capacidade:
+// em c=1e10 as pioras chegam a milhões e em c=1e6 a poucas centenas, então boa parte
+// do resfriamento vira passeio aleatório ou descida pura. Aqui a temperatura é a que
+// dá uma taxa de aceitação média alvo sobre as pioras d > 0 observadas:
+//     media(exp(-d / T)) = alvo,
+// resolvida por bisseção em log(T) (a taxa é crescente em T). T0 usa alvo alto
+// (80%) e Tf alvo baixo (0.1%).
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+struct TemperatureTargets {
+	double initialAcceptance = 0.8;   // taxa de aceitação de pioras no início
+	double finalAcceptance = 0.001;   // e no fim do resfriamento
+};
+
+struct TemperatureSchedule {
+	double initial = 0.0, final = 0.0;
+	bool valid() const { return initial > 0.0 && final > 0.0 && final < initial; }
+};
+
+// Taxa média de aceitação das pioras (d > 0) na temperatura T
+inline double acceptanceAt(const std::vector<double> &worsening, double T){
+	if(worsening.empty()) return 0.0;
+	double sum = 0.0;
+	for(double d : worsening) sum += std::exp(-d / T);
+	return sum / static_cast<double>(worsening.size());
+}
+
+// Temperatura com taxa de aceitação média target (0 < target < 1); 0 sem amostras
+inline double temperatureForAcceptance(const std::vector<double> &worsening, double target){
+	if(worsening.empty()) return 0.0;
+	double dMin = worsening[0], dMax = worsening[0];
+	for(double d : worsening){ dMin = std::min(dMin, d); dMax = std::max(dMax, d); }
+	// exp(-dMin/lo) ~ 0 e exp(-dMax/hi) ~ 1: o alvo fica entre os dois
+	double lo = std::log(dMin * 1e-3), hi = std::log(dMax * 1e3);
+	while(hi - lo > 1e-4){ // T com erro relativo < 1e-4 (~20 iterações)
+		double mid = 0.5 * (lo + hi);
+		if(acceptanceAt(worsening, std::exp(mid)) < target) lo = mid; else hi = mid;
+	}
+	return std::exp(0.5 * (lo + hi));
+}
+
+// T0 e Tf para as taxas alvo; schedule.valid() falso sem pioras amostradas
+inline TemperatureSchedule calibrateSchedule(const std::vector<double> &worsening, const TemperatureTargets &targets = TemperatureTargets()){
+	TemperatureSchedule schedule;
+	schedule.initial = temperatureForAcceptance(worsening, targets.initialAcceptance);
+	schedule.final = temperatureForAcceptance(worsening, targets.finalAcceptance);
+	return schedule;
+}
+
+#endif
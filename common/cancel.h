@@ -0,0 +1,52 @@
+#ifndef KNAPSACK_CANCEL_H
+#define KNAPSACK_CANCEL_H
+
+// Coordenação de solvers que correm juntos sobre a mesma instância.
+//
+// CancelToken: cancelamento cooperativo por pedido explícito (cancel(), de outra
+// thread), por prazo (arm(ms)) ou pelo token pai (parent). Os solvers consultam
+// cancelled() nos mesmos pontos em que já olham o relógio ou o orçamento (fim de
+// patamar do SA, a cada 1024 nós do B&B, a cada item da DP), então um token
+// desarmado custa só uma leitura atômica.
+//
+// SharedBound: lucro da melhor solução viável conhecida por qualquer um deles, para
+// os métodos exatos podarem com a incumbente da heurística.
+
+#include <atomic>
+#include <chrono>
+
+struct CancelToken {
+	std::atomic<bool> flag{false};
+	bool timed = false;
+	std::chrono::steady_clock::time_point deadline;
+	CancelToken *parent = nullptr; // cancelado também quando o pai for
+
+	// Novo trabalho: limpa o pedido e define o prazo (ms <= 0: sem prazo)
+	void arm(long long ms){
+		flag.store(false, std::memory_order_relaxed);
+		timed = (ms > 0);
+		if(timed) deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+	}
+	void cancel(){ flag.store(true, std::memory_order_relaxed); }
+
+	bool cancelled(){
+		if(flag.load(std::memory_order_relaxed)) return true;
+		if((timed && std::chrono::steady_clock::now() >= deadline) || (parent && parent->cancelled())){ cancel(); return true; }
+		return false;
+	}
+	// Só o estado já registrado (sem ler o relógio)
+	bool wasCancelled() const { return flag.load(std::memory_order_relaxed); }
+};
+
+struct SharedBound {
+	std::atomic<long long> profit{-1};
+
+	long long load() const { return profit.load(std::memory_order_relaxed); }
+	// Publica p se for melhor que o atual
+	void offer(long long p){
+		long long cur = profit.load(std::memory_order_relaxed);
+		while(p > cur && !profit.compare_exchange_weak(cur, p, std::memory_order_relaxed)){}
+	}
+};
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef KNAPSACK_EXACT_DP_H
+#define KNAPSACK_EXACT_DP_H
+
+// Solver exato por programação dinâmica sobre a capacidade.
+//
+// 1. Redução (common/reduction.h): com a incumbente (ex.: gulosa) fixa os itens cujo
+//    limite de Dantzig prova que estão dentro/fora de qualquer solução melhor e os
+//    dominados que não cabem com seus dominantes; sobram os itens do "núcleo" e a
+//    capacidade residual C' = C - pesos fixados em 1.
+// 2. Tabela única f[0..C'] de int64 (f[w] = maior lucro com peso <= w), atualizada
+//    in-place em ordem decrescente de w: f[w] = max(f[w], f[w-w_k] + p_k), com
+//    kernels AVX-512/AVX2 de 8/4 posições por vez (escolhidos na compilação: só com
+//    -march=native ou -mavx2/-mavx512f; sem eles fica o laço escalar).
+// 3. Faixas de peso: com T = min(C', peso livre total), o item k só atualiza w em
+//    [max(w_k, T - S_k), min(T, R_k)], onde S_k é o peso dos itens ainda não
+//    processados e R_k o dos já processados (abaixo dessa faixa nada é lido de novo;
+//    acima a tabela é constante). Os itens são processados do mais pesado ao mais
+//    leve, o que encurta as últimas faixas.
+// 4. Reconstrução opcional: um bit por (item, w) dentro da faixa de cada item.
+//
+// A memória (tabela + bits) é limitada por DPOptions::maxBytes; acima disso o
+// solver desiste e devolve apenas a incumbente com o limite de Dantzig. O mesmo
+// acontece se DPOptions::cancel for acionado no meio da tabela.
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "itemStore.h"
+#include "solution.h"
+#include "bounds.h"
+#include "reduction.h"
+#include "cancel.h"
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+struct DPOptions {
+	bool reconstruct = false;            // guarda os bits de decisão e devolve a solução ótima
+	size_t maxBytes = size_t(512) << 20; // limite de memória da tabela + bits
+	CancelToken *cancel = nullptr;       // consultado a cada item (cancelada: fica a incumbente)
+};
+
+// Marca em bits os 8 (ou menos) valores de mask a partir da posição pos
+inline void dpSetBits(uint64_t *bits, long long pos, unsigned mask){
+	long long word = pos >> 6;
+	int sh = static_cast<int>(pos & 63);
+	bits[word] |= static_cast<uint64_t>(mask) << sh;
+	if(sh > 56) bits[word + 1] |= static_cast<uint64_t>(mask) >> (64 - sh);
+}
+
+// f[w] = max(f[w], f[w-wt] + p) para w em [lo, hi], decrescente e in-place (lo >= wt).
+// Cada bloco lê f[w-wt..] antes de gravar f[w..]; como w-wt < w, nada é lido depois
+// de atualizado por este mesmo item. keep (opcional): bit (w - base) = item melhorou f[w].
+inline void dpRelax(long long *f, long long lo, long long hi, long long wt, long long p, uint64_t *keep, long long base){
+	long long w = hi;
+#if defined(__AVX512F__)
+	const __m512i vp = _mm512_set1_epi64(p);
+	for(; w - 7 >= lo; w -= 8){
+		long long s = w - 7;
+		__m512i cur = _mm512_loadu_si512(f + s);
+		__m512i cand = _mm512_add_epi64(_mm512_loadu_si512(f + s - wt), vp);
+		__mmask8 m = _mm512_cmpgt_epi64_mask(cand, cur);
+		_mm512_mask_storeu_epi64(f + s, m, cand);
+		if(keep && m) dpSetBits(keep, s - base, m);
+	}
+#elif defined(__AVX2__)
+	const __m256i vp = _mm256_set1_epi64x(p);
+	for(; w - 3 >= lo; w -= 4){
+		long long s = w - 3;
+		__m256i cur = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(f + s));
+		__m256i cand = _mm256_add_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(f + s - wt)), vp);
+		__m256i gt = _mm256_cmpgt_epi64(cand, cur);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(f + s), _mm256_blendv_epi8(cur, cand, gt));
+		if(keep){
+			unsigned m = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(gt)));
+			if(m) dpSetBits(keep, s - base, m);
+		}
+	}
+#endif
+	for(; w >= lo; --w){
+		long long cand = f[w - wt] + p;
+		if(cand > f[w]){
+			f[w] = cand;
+			if(keep) keep[(w - base) >> 6] |= 1ULL << ((w - base) & 63);
+		}
+	}
+}
+
+// Resolve a instância (it, capacity) de forma exata.
+// incumbent/incumbentProfit: solução viável conhecida (limite inferior da redução).
+// out (opcional, requer opt.reconstruct): recebe a solução ótima.
+inline ExactResult solveExactDP(const ItemStore &it, long long capacity, const Solution &incumbent, long long incumbentProfit, const DPOptions &opt, Solution *out = nullptr){
+	ExactResult res;
+	res.profit = incumbentProfit;
+	if(out) out->copyFrom(incumbent);
+
+	ReducedProblem red;
+	reduceProblem(it, capacity, incumbentProfit, red);
+	res.upperBound = red.upperBound;
+	res.freeItems = red.n();
+	res.reducedCapacity = red.capacity;
+	if(red.closed){ // nenhuma solução melhor que a incumbente
+		res.optimal = true;
+		return res;
+	}
+	const ItemStore &core = red.core;
+	long long fixedProfit = red.fixedProfit, residual = red.capacity;
+	std::vector<int> items(core.n); // itens do núcleo
+	for(int k=0; k<core.n; ++k) items[k] = k;
+
+	// Do mais pesado ao mais leve; faixas [lo_k, hi_k] de cada item
+	std::sort(items.begin(), items.end(), [&core](int a, int b){ return core.weight[a] > core.weight[b]; });
+	int m = static_cast<int>(items.size());
+	std::vector<long long> lo(m), hi(m), suffix(m + 1, 0);
+	for(int k=m-1; k>=0; --k) suffix[k] = suffix[k+1] + core.weight[items[k]];
+	long long target = std::min(residual, suffix[0]); // posição final lida: f[target]
+	long long reach = 0; // peso total dos itens já processados, limitado a target
+	size_t keepWords = 0;
+	std::vector<size_t> keepOffset(m + 1, 0);
+	for(int k=0; k<m; ++k){
+		long long wk = core.weight[items[k]];
+		reach = std::min(target, reach + wk);
+		lo[k] = std::max(wk, target - suffix[k+1]);
+		hi[k] = reach;
+		keepOffset[k] = keepWords;
+		if(opt.reconstruct && lo[k] <= hi[k])
+			keepWords += static_cast<size_t>(((hi[k] - (lo[k] & ~63LL)) >> 6) + 2);
+	}
+	keepOffset[m] = keepWords;
+	size_t bytes = sizeof(long long) * static_cast<size_t>(reach + 8) + sizeof(uint64_t) * keepWords;
+	if(bytes > opt.maxBytes) return res; // grande demais: fica a incumbente e o limite
+
+	std::vector<long long> f(static_cast<size_t>(reach) + 1, 0);
+	std::vector<uint64_t> keep(keepWords, 0);
+	long long filled = 0; // f[0..filled] válidos; acima, constantes = f[filled]
+	for(int k=0; k<m; ++k){
+		if(opt.cancel && opt.cancel->cancelled()){ res.cancelled = true; return res; }
+		if(hi[k] > filled){
+			std::fill(f.begin() + filled + 1, f.begin() + hi[k] + 1, f[filled]);
+			filled = hi[k];
+		}
+		if(lo[k] > hi[k]) continue;
+		int i = items[k];
+		uint64_t *bits = opt.reconstruct ? keep.data() + keepOffset[k] : nullptr;
+		dpRelax(f.data(), lo[k], hi[k], core.weight[i], core.profit[i], bits, lo[k] & ~63LL);
+	}
+	long long best = fixedProfit + f[reach];
+	res.optimal = true;
+	if(best > incumbentProfit){
+		res.profit = best;
+		if(out && opt.reconstruct){
+			Solution coreSol(core.n);
+			long long w = reach;
+			for(int k=m-1; k>=0; --k){
+				if(w > hi[k]) w = hi[k]; // acima de hi a tabela do item k é constante
+				if(w < lo[k]) continue;
+				long long base = lo[k] & ~63LL;
+				const uint64_t *bits = keep.data() + keepOffset[k];
+				if((bits[(w - base) >> 6] >> ((w - base) & 63)) & 1ULL){
+					coreSol.set(items[k], true);
+					w -= core.weight[items[k]];
+				}
+			}
+			red.expand(coreSol, *out);
+		}
+	}
+	res.upperBound = res.profit;
+	return res;
+}
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef KNAPSACK_GREEDY_H
+#define KNAPSACK_GREEDY_H
+
+// Gulosa por razão lucro/peso sem ordenar a instância inteira.
+//  1. Item crítico (Balas–Zemel): seleção pela mediana (nth_element) em blocos que
+//     encolhem pela metade até achar o primeiro item, na ordem ratioBefore, que não
+//     cabe mais. Tudo antes dele entra; custo linear esperado.
+//  2. Cauda: dos itens depois do crítico só se ordenam os que ainda cabem na folga,
+//     percorridos como na gulosa clássica.
+// O resultado é idêntico ao da gulosa sobre a ordenação completa (ratioBefore é uma
+// ordem total), e a conta é toda em long long (capacidades acima de 2^31).
+
+#include <algorithm>
+#include <vector>
+#include "itemStore.h"
+#include "solution.h"
+#include "instrument.h" // KNAPSA_PHASE
+
+// Buffers reaproveitados entre instâncias
+struct GreedyScratch {
+	std::vector<int> idx;  // permutação particionada ao redor do item crítico
+	std::vector<int> tail; // itens depois do crítico que ainda cabem
+};
+
+struct GreedyResult {
+	long long profit = 0;
+	long long weight = 0;
+	int critical = -1;              // item crítico (-1: todos cabem)
+	long long criticalWeight = 0;   // peso e lucro dos itens antes do crítico
+	long long criticalProfit = 0;
+};
+
+// Particiona scratch.idx de modo que idx[0..h) sejam os itens antes do crítico (em
+// qualquer ordem), idx[h] o crítico e idx[h+1..n) os depois dele; devolve h (n se
+// todos cabem) e o peso/lucro de idx[0..h).
+inline int findCriticalItem(const ItemStore &it, long long capacity, std::vector<int> &idx,
+                            long long &weightBefore, long long &profitBefore){
+	int n = it.n;
+	const long long *p = it.profit, *w = it.weight;
+	idx.resize(n);
+	for(int i=0; i<n; ++i) idx[i] = i;
+	auto before = [p, w](int a, int b){ return ratioBefore(p, w, a, b); };
+	weightBefore = profitBefore = 0;
+	int lo = 0, hi = n; // idx[0..lo) cabem e vêm antes do crítico; o crítico está em [lo, hi) se hi < n
+	while(lo < hi){
+		int mid = lo + (hi - lo) / 2;
+		std::nth_element(idx.begin() + lo, idx.begin() + mid, idx.begin() + hi, before);
+		long long wl = 0, pl = 0;
+		for(int k=lo; k<mid; ++k){ wl += w[idx[k]]; pl += p[idx[k]]; }
+		if(weightBefore + wl > capacity){
+			hi = mid; // o crítico está na metade de cima da ordem
+		}else if(weightBefore + wl + w[idx[mid]] > capacity){
+			weightBefore += wl; profitBefore += pl;
+			return mid;
+		}else{
+			weightBefore += wl + w[idx[mid]];
+			profitBefore += pl + p[idx[mid]];
+			lo = mid + 1;
+		}
+	}
+	return n;
+}
+
+// Gulosa: marca em sol (que deve chegar zerada) os itens escolhidos e devolve o lucro
+inline GreedyResult greedySolve(const ItemStore &it, long long capacity, Solution &sol, GreedyScratch &scratch){
+	KNAPSA_PHASE(PHASE_GREEDY);
+	GreedyResult r;
+	int n = it.n;
+	const long long *p = it.profit, *w = it.weight;
+	std::vector<int> &idx = scratch.idx;
+	int h = findCriticalItem(it, capacity, idx, r.criticalWeight, r.criticalProfit);
+	for(int k=0; k<h; ++k) sol.set(idx[k], true);
+	r.weight = r.criticalWeight;
+	r.profit = r.criticalProfit;
+	if(h == n) return r;
+	r.critical = idx[h];
+	long long residual = capacity - r.weight;
+	std::vector<int> &tail = scratch.tail;
+	tail.clear();
+	for(int k=h+1; k<n; ++k) if(w[idx[k]] <= residual) tail.push_back(idx[k]);
+	std::sort(tail.begin(), tail.end(), [p, w](int a, int b){ return ratioBefore(p, w, a, b); });
+	for(int i : tail){
+		if(w[i] <= residual){
+			sol.set(i, true);
+			residual -= w[i];
+			r.weight += w[i];
+			r.profit += p[i];
+		}
+	}
+	return r;
+}
+
+inline GreedyResult greedySolve(const ItemStore &it, long long capacity, Solution &sol){
+	GreedyScratch scratch;
+	return greedySolve(it, capacity, sol, scratch);
+}
+
+#endif
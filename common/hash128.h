@@ -0,0 +1,40 @@
+#ifndef KNAPSACK_HASH128_H
+#define KNAPSACK_HASH128_H
+
+// Hash de 128 bits das chaves de resultado (cache de resultados, diário da varredura)
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Hash de 128 bits em duas faixas independentes (mistura do splitmix64); não é
+// criptográfico, só precisa tornar colisões acidentais improváveis
+struct Hash128 {
+	uint64_t lo = 0x243F6A8885A308D3ULL, hi = 0x13198A2E03707344ULL;
+
+	static uint64_t mix(uint64_t x){
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+		return x ^ (x >> 31);
+	}
+	void add(uint64_t x){
+		lo = mix(lo ^ x) + 0x9E3779B97F4A7C15ULL;
+		hi = mix(hi + x * 0xD6E8FEB86659FD93ULL) ^ (lo >> 17);
+	}
+	void add(const void *data, size_t bytes){
+		const unsigned char *p = static_cast<const unsigned char*>(data);
+		add(static_cast<uint64_t>(bytes));
+		for(; bytes >= 8; bytes -= 8, p += 8){ uint64_t x; memcpy(&x, p, 8); add(x); }
+		uint64_t tail = 0;
+		if(bytes) memcpy(&tail, p, bytes);
+		add(tail);
+	}
+	void add(const char *s){ add(s, strlen(s)); }
+	bool operator==(const Hash128 &o) const { return lo == o.lo && hi == o.hi; }
+};
+
+struct Hash128Hasher {
+	size_t operator()(const Hash128 &h) const { return static_cast<size_t>(h.lo ^ (h.hi * 0x9E3779B97F4A7C15ULL)); }
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef KNAPSACK_INSTANCE_PARAMS_H
+#define KNAPSACK_INSTANCE_PARAMS_H
+
+// Parâmetros de geração codificados no nome do diretório da instância:
+// n_400_c_1000000_g_14_f_0.1_eps_0_s_100
+//n - number of itens
+//c - capacity
+//g - groups of itens
+//f - influences the number of items in the different groups (fraction of items in the last group)
+//eps - influences in the calculation of profit and weight
+//s - numbers sampled between 1 and s
+
+#include <stdlib.h> // strtoll, strtod
+#include <string.h>
+#include <string>
+
+struct InstanceParams {
+	int n = -1;
+	long long c = -1;
+	int g = -1;
+	double f = -1.0;
+	double eps = -1.0;
+	int s = -1;
+};
+
+// Lê os pares chave_valor de name; retorna true se os seis campos foram encontrados
+inline bool parseInstanceParams(const char *name, InstanceParams &out){
+	out = InstanceParams();
+	int found = 0;
+	const char *p = name;
+	while(*p){
+		const char *keyEnd = strchr(p, '_');
+		if(keyEnd == NULL) break;
+		const char *val = keyEnd + 1;
+		const char *valEnd = strchr(val, '_');
+		if(valEnd == NULL) valEnd = val + strlen(val);
+		std::string key(p, keyEnd - p), value(val, valEnd - val);
+		if(key == "n"){ out.n = atoi(value.c_str()); found |= 1; }
+		else if(key == "c"){ out.c = strtoll(value.c_str(), NULL, 10); found |= 2; }
+		else if(key == "g"){ out.g = atoi(value.c_str()); found |= 4; }
+		else if(key == "f"){ out.f = strtod(value.c_str(), NULL); found |= 8; }
+		else if(key == "eps"){ out.eps = strtod(value.c_str(), NULL); found |= 16; }
+		else if(key == "s"){ out.s = atoi(value.c_str()); found |= 32; }
+		p = (*valEnd) ? valEnd + 1 : valEnd;
+	}
+	return found == 63;
+}
+
+// Nome da instância a partir de um caminho: .../<nome>/test.in -> <nome>;
+// rótulos de arquivo compactado "<arquivo>:<nome>" -> <nome>; outros -> nome do arquivo sem extensão
+inline std::string instanceNameFromPath(const std::string &path){
+	size_t colon = path.rfind(':');
+	size_t sep = path.find_last_of("/\\");
+	if(colon != std::string::npos && colon > 1 && (sep == std::string::npos || colon > sep))
+		return path.substr(colon + 1);
+	std::string file = (sep == std::string::npos) ? path : path.substr(sep + 1);
+	if(file == "test.in" && sep != std::string::npos && sep > 0){
+		size_t sep2 = path.find_last_of("/\\", sep - 1);
+		return path.substr(sep2 == std::string::npos ? 0 : sep2 + 1, sep - (sep2 == std::string::npos ? 0 : sep2 + 1));
+	}
+	size_t dot = file.rfind('.');
+	return (dot == std::string::npos || dot == 0) ? file : file.substr(0, dot);
+}
+
+#endif
@@ -0,0 +1,296 @@
+#ifndef KNAPSACK_INSTANCE_READER_H
+#define KNAPSACK_INSTANCE_READER_H
+
+// Leitura das instâncias (test.in) sem cópias: o arquivo é mapeado em memória
+// (mmap / MapViewOfFile) e os inteiros são lidos direto do mapeamento por um
+// scanner próprio, sem fgets/strlen/strtok/atoi nem std::istringstream.
+//
+// Formato:
+// 0: N (número de itens)
+// 1..N: id lucro peso   (id deve ser igual a linha-1)
+// N+1: capacidade
+// Espaços, tabulações, \r e \n são todos separadores (arquivos com CRLF funcionam).
+//
+// Também lê o formato binário gerado por tools/knapPack.cpp (detectado pelo
+// número mágico), tanto uma instância avulsa (.knpb) quanto uma entrada de um
+// arquivo compactado (.knpa) indicada como "<arquivo.knpa>:<nome da instância>".
+
+#include <limits.h> // LLONG_MAX
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h> // memcpy, memcmp
+#include <string>
+#include "itemStore.h"
+#include "instanceParams.h"
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX // evita as macros min/max (std::min/std::max)
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close
+#endif
+
+enum LoadStatus {
+	LOAD_OK = 0,
+	LOAD_OPEN_FAILED, // arquivo inexistente/ilegível
+	LOAD_NO_MEMORY,   // falha ao alocar as colunas
+	LOAD_MALFORMED,   // N inválido, token não numérico ou arquivo truncado
+	LOAD_INVALID_ID   // id != linha-1
+};
+
+// Detalhes do erro de id (para as mensagens de cada solver)
+struct LoadDiag {
+	int expectedId = -1;
+	long long foundId = -1;
+};
+
+// Arquivo somente leitura mapeado em memória
+struct MappedFile {
+	const char *data = nullptr;
+	size_t size = 0;
+#if defined(_WIN32)
+	HANDLE file = INVALID_HANDLE_VALUE, mapping = NULL;
+#endif
+
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile(){ close(); }
+
+	bool open(const char *fileName){
+		close();
+#if defined(_WIN32)
+		file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if(file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER len;
+		if(!GetFileSizeEx(file, &len)){ close(); return false; }
+		size = static_cast<size_t>(len.QuadPart);
+		if(size == 0){ data = ""; return true; }
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if(mapping == NULL){ close(); return false; }
+		data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		if(data == nullptr){ close(); return false; }
+#else
+		int fd = ::open(fileName, O_RDONLY);
+		if(fd < 0) return false;
+		struct stat st;
+		if(fstat(fd, &st) != 0){ ::close(fd); return false; }
+		size = static_cast<size_t>(st.st_size);
+		if(size == 0){ ::close(fd); data = ""; return true; }
+		void *m = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd); // o mapeamento continua válido
+		if(m == MAP_FAILED){ size = 0; return false; }
+		madvise(m, size, MADV_SEQUENTIAL);
+		data = static_cast<const char*>(m);
+#endif
+		return true;
+	}
+
+	void close(){
+#if defined(_WIN32)
+		if(data != nullptr && size > 0) UnmapViewOfFile(data);
+		if(mapping != NULL) CloseHandle(mapping);
+		if(file != INVALID_HANDLE_VALUE) CloseHandle(file);
+		mapping = NULL; file = INVALID_HANDLE_VALUE;
+#else
+		if(data != nullptr && size > 0) munmap(const_cast<char*>(data), size);
+#endif
+		data = nullptr; size = 0;
+	}
+};
+
+// Lê o próximo inteiro (com sinal opcional) de [p, end); pula separadores antes.
+// Retorna false se não houver número (fim do buffer ou caractere inesperado) ou se
+// ele não couber em long long.
+inline bool scanInt(const char *&p, const char *end, long long &out){
+	while(p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+	if(p == end) return false;
+	bool neg = (*p == '-');
+	p += neg;
+	const char *start = p;
+	unsigned long long v = 0;
+	unsigned d;
+	while(p < end && (d = static_cast<unsigned>(*p - '0')) < 10u){
+		if(v > (static_cast<unsigned long long>(LLONG_MAX) - d) / 10u) return false;
+		v = v * 10u + d;
+		++p;
+	}
+	if(p == start) return false;
+	out = neg ? -static_cast<long long>(v) : static_cast<long long>(v);
+	return true;
+}
+
+// Interpreta o texto de uma instância já em memória e preenche store/capacity
+inline LoadStatus parseInstanceText(const char *p, const char *end, ItemStore &store, long long &capacity, LoadDiag *diag = nullptr){
+	long long n;
+	if(!scanInt(p, end, n) || n < 0 || n > 0x7fffffff) return LOAD_MALFORMED;
+	// cada item ocupa pelo menos 6 bytes ("0 0 0\n"): um N maior que o arquivo comporta
+	// é texto malformado, e não deve virar uma alocação de gigabytes
+	if(n > (end - p) / 6) return LOAD_MALFORMED;
+	if(!store.resize(static_cast<int>(n))) return LOAD_NO_MEMORY;
+	long long *profit = store.profit, *weight = store.weight;
+	for(int i=0; i<store.n; ++i){
+		long long id, pr, wt;
+		if(!scanInt(p, end, id)) return LOAD_MALFORMED;
+		if(id != i){
+			if(diag){ diag->expectedId = i; diag->foundId = id; }
+			return LOAD_INVALID_ID;
+		}
+		if(!scanInt(p, end, pr) || !scanInt(p, end, wt)) return LOAD_MALFORMED;
+		profit[i] = pr;
+		weight[i] = wt;
+	}
+	if(!scanInt(p, end, capacity)) return LOAD_MALFORMED;
+	store.finalize(); // invalida a ordem por razão da instância anterior
+	return LOAD_OK;
+}
+
+// ---- Formato binário (little-endian) ----
+// Instância (.knpb):
+//   BinaryInstanceHeader (64 bytes)
+//   profit[n] (int64) a partir do byte 64, completado até múltiplo de 64 bytes
+//   weight[n] (int64) logo em seguida, também completado
+// Arquivo compactado (.knpa):
+//   BinaryArchiveHeader (64 bytes), instâncias .knpb em offsets múltiplos de 64
+//   e, em indexOffset, count BinaryArchiveEntry ordenadas por nome
+// Mudanças de layout devem incrementar a versão correspondente.
+
+static const char BINARY_INSTANCE_MAGIC[4] = {'K','N','P','B'};
+static const char BINARY_ARCHIVE_MAGIC[4] = {'K','N','P','A'};
+static const uint32_t BINARY_INSTANCE_VERSION = 1;
+static const uint32_t BINARY_ARCHIVE_VERSION = 1;
+static const uint32_t BINARY_HAS_PARAMS = 1u; // flags: parâmetros n/c/g/f/eps/s preenchidos
+
+struct BinaryInstanceHeader {
+	char magic[4];
+	uint32_t version;
+	int32_t n;
+	uint32_t flags;
+	int64_t capacity;
+	int64_t paramC;
+	int32_t paramN, paramG, paramS, reserved;
+	double paramF, paramEps;
+};
+static_assert(sizeof(BinaryInstanceHeader) == 64, "cabeçalho binário deve ter 64 bytes");
+
+struct BinaryArchiveHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t count;
+	uint32_t reserved;
+	uint64_t indexOffset;
+	uint64_t totalItems; // soma dos n (informativo)
+	char pad[32];
+};
+static_assert(sizeof(BinaryArchiveHeader) == 64, "cabeçalho do arquivo compactado deve ter 64 bytes");
+
+struct BinaryArchiveEntry {
+	uint64_t offset; // início do bloco .knpb dentro do arquivo compactado
+	uint64_t bytes;
+	char name[112];  // nome do diretório da instância, terminado em '\0'
+};
+static_assert(sizeof(BinaryArchiveEntry) == 128, "entrada do índice deve ter 128 bytes");
+
+// Bytes de uma coluna de n inteiros de 64 bits, completada até múltiplo de 64
+inline size_t binaryColumnBytes(int n){ return (static_cast<size_t>(n) * sizeof(int64_t) + 63) & ~static_cast<size_t>(63); }
+inline size_t binaryInstanceBytes(int n){ return sizeof(BinaryInstanceHeader) + 2 * binaryColumnBytes(n); }
+
+// Interpreta uma instância binária em [data, data+size)
+inline LoadStatus parseInstanceBinary(const char *data, size_t size, ItemStore &store, long long &capacity, InstanceParams *params = nullptr){
+	BinaryInstanceHeader h;
+	if(size < sizeof(h)) return LOAD_MALFORMED;
+	memcpy(&h, data, sizeof(h));
+	if(memcmp(h.magic, BINARY_INSTANCE_MAGIC, 4) != 0 || h.version != BINARY_INSTANCE_VERSION || h.n < 0) return LOAD_MALFORMED;
+	if(size < binaryInstanceBytes(h.n)) return LOAD_MALFORMED;
+	if(!store.resize(h.n)) return LOAD_NO_MEMORY;
+	const char *col = data + sizeof(h);
+	memcpy(store.profit, col, sizeof(int64_t) * h.n);
+	memcpy(store.weight, col + binaryColumnBytes(h.n), sizeof(int64_t) * h.n);
+	capacity = h.capacity;
+	if(params){
+		*params = InstanceParams();
+		if(h.flags & BINARY_HAS_PARAMS){
+			params->n = h.paramN; params->c = h.paramC; params->g = h.paramG;
+			params->f = h.paramF; params->eps = h.paramEps; params->s = h.paramS;
+		}
+	}
+	store.finalize();
+	return LOAD_OK;
+}
+
+// Arquivo compactado (.knpa) aberto para leitura; as entradas ficam no mapeamento
+struct InstanceArchive {
+	MappedFile file;
+	BinaryArchiveHeader header;
+	const BinaryArchiveEntry *entries = nullptr;
+
+	bool open(const char *fileName){
+		entries = nullptr;
+		if(!file.open(fileName) || file.size < sizeof(header)) return false;
+		memcpy(&header, file.data, sizeof(header));
+		if(memcmp(header.magic, BINARY_ARCHIVE_MAGIC, 4) != 0 || header.version != BINARY_ARCHIVE_VERSION) return false;
+		if(header.indexOffset > file.size || (file.size - header.indexOffset) / sizeof(BinaryArchiveEntry) < header.count) return false;
+		entries = reinterpret_cast<const BinaryArchiveEntry*>(file.data + header.indexOffset);
+		return true;
+	}
+	int count() const { return entries ? static_cast<int>(header.count) : 0; }
+	const char* name(int i) const { return entries[i].name; }
+
+	// Índice da instância com esse nome (busca binária) ou -1
+	int find(const char *instanceName) const {
+		int lo = 0, hi = count() - 1;
+		while(lo <= hi){
+			int mid = (lo + hi) / 2;
+			int c = strncmp(entries[mid].name, instanceName, sizeof(entries[mid].name));
+			if(c == 0) return mid;
+			if(c < 0) lo = mid + 1; else hi = mid - 1;
+		}
+		return -1;
+	}
+
+	LoadStatus load(int i, ItemStore &store, long long &capacity, InstanceParams *params = nullptr) const {
+		if(i < 0 || i >= count()) return LOAD_OPEN_FAILED;
+		const BinaryArchiveEntry &e = entries[i];
+		if(e.offset > file.size || e.bytes > file.size - e.offset) return LOAD_MALFORMED;
+		return parseInstanceBinary(file.data + e.offset, e.bytes, store, capacity, params);
+	}
+};
+
+// true se fileName começa com o número mágico do arquivo compactado
+inline bool isInstanceArchive(const char *fileName){
+	FILE *f = fopen(fileName, "rb");
+	if(f == NULL) return false;
+	char magic[4];
+	bool ok = fread(magic, 1, 4, f) == 4 && memcmp(magic, BINARY_ARCHIVE_MAGIC, 4) == 0;
+	fclose(f);
+	return ok;
+}
+
+// Mapeia fileName e carrega a instância em store (já finalizada) e capacity.
+// Aceita texto, .knpb ou "<arquivo.knpa>:<nome>"; params (opcional) recebe
+// n/c/g/f/eps/s do cabeçalho binário ou do nome do diretório.
+inline LoadStatus loadInstance(const char *fileName, ItemStore &store, long long &capacity, LoadDiag *diag = nullptr, InstanceParams *params = nullptr){
+	MappedFile file;
+	if(!file.open(fileName)){
+		// "<arquivo>:<nome>" (o ':' precisa vir depois do último separador, por causa de C:\)
+		const char *colon = strrchr(fileName, ':');
+		const char *sep = strrchr(fileName, '/');
+		const char *bsep = strrchr(fileName, '\\');
+		if(bsep > sep) sep = bsep;
+		if(colon == NULL || colon == fileName || (sep != NULL && colon < sep)) return LOAD_OPEN_FAILED;
+		InstanceArchive archive;
+		if(!archive.open(std::string(fileName, colon - fileName).c_str())) return LOAD_OPEN_FAILED;
+		return archive.load(archive.find(colon + 1), store, capacity, params);
+	}
+	if(file.size >= 4 && memcmp(file.data, BINARY_INSTANCE_MAGIC, 4) == 0)
+		return parseInstanceBinary(file.data, file.size, store, capacity, params);
+	if(params) parseInstanceParams(instanceNameFromPath(fileName).c_str(), *params);
+	return parseInstanceText(file.data, file.data + file.size, store, capacity, diag);
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef KNAPSACK_INSTRUMENT_H
+#define KNAPSACK_INSTRUMENT_H
+
+// Instrumentação do SA, ligada só quando compilado com -DKNAPSA_INSTRUMENT: sem a
+// macro, KNAPSA_STAT(...) e KNAPSA_PHASE(...) não geram código e o laço quente fica
+// idêntico ao de produção.
+//  - contadores por cadeia (cada cadeia roda em uma thread): movimentos, aceitos,
+//    pioras aceitas, vizinhos inviáveis, melhorias, e os mesmos por patamar de temperatura;
+//  - tempos por fase (leitura, ordenação por razão, gulosa, SA) pelo contador
+//    de ciclos (TSC), acumulados por thread e convertidos em ns ao final.
+
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc
+#endif
+
+#ifdef KNAPSA_INSTRUMENT
+#define KNAPSA_STAT(...) __VA_ARGS__
+#define KNAPSA_PHASE_CAT(a, b) a##b
+#define KNAPSA_PHASE_NAME(line) KNAPSA_PHASE_CAT(knapsaPhase, line)
+#define KNAPSA_PHASE(phase) ScopedPhase KNAPSA_PHASE_NAME(__LINE__)(phase)
+#else
+#define KNAPSA_STAT(...)
+#define KNAPSA_PHASE(phase)
+#endif
+
+// Ciclos do TSC (ou ns do relógio monotônico fora de x86)
+inline uint64_t readCycles(){
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// ns por ciclo, medido uma vez contra o relógio monotônico (~5 ms)
+inline double nsPerCycle(){
+	static double ratio = 0.0;
+	if(ratio == 0.0){
+		auto t0 = std::chrono::steady_clock::now();
+		uint64_t c0 = readCycles();
+		while(std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(5)){}
+		uint64_t c1 = readCycles();
+		double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count());
+		ratio = (c1 > c0) ? ns / static_cast<double>(c1 - c0) : 1.0;
+	}
+	return ratio;
+}
+
+enum Phase { PHASE_PARSE = 0, PHASE_SORT, PHASE_GREEDY, PHASE_SA, PHASE_COUNT };
+inline const char *phaseName(int p){
+	static const char *names[PHASE_COUNT] = {"parse", "sort", "greedy", "sa"};
+	return names[p];
+}
+
+// Ciclos acumulados por fase na thread (sort: a primeira chamada de ratioOrder(), feita
+// pela redução, ligada por padrão, pelos limites e pelos solvers exatos)
+struct PhaseTimes {
+	uint64_t cycles[PHASE_COUNT] = {0, 0, 0, 0};
+	void reset(){ for(int p=0; p<PHASE_COUNT; ++p) cycles[p] = 0; }
+};
+inline PhaseTimes &threadPhases(){
+	static thread_local PhaseTimes times;
+	return times;
+}
+
+struct ScopedPhase {
+	int phase;
+	uint64_t start;
+	explicit ScopedPhase(int p) : phase(p), start(readCycles()) {}
+	~ScopedPhase(){ threadPhases().cycles[phase] += readCycles() - start; }
+};
+
+// Contadores de um patamar de temperatura (ou de uma cadeia inteira)
+struct LevelStats {
+	double temperature = 0.0;
+	uint64_t moves = 0;              // movimentos avaliados
+	uint64_t accepts = 0;            // aceitos (melhoras e pioras)
+	uint64_t uphill = 0;             // pioras aceitas pelo critério de Metropolis
+	uint64_t infeasible = 0;         // vizinhos acima da capacidade
+	uint64_t infeasibleAccepted = 0; // aceitos que deixam a solução corrente inviável
+	uint64_t cycles = 0;
+
+	void add(const LevelStats &o){
+		moves += o.moves; accepts += o.accepts; uphill += o.uphill;
+		infeasible += o.infeasible; infeasibleAccepted += o.infeasibleAccepted; cycles += o.cycles;
+	}
+};
+
+struct SAStats {
+	LevelStats total;
+	uint64_t improvements = 0;      // vezes em que a melhor solução da cadeia melhorou
+	long long lastImproveMove = -1; // movimento e patamar da última melhora
+	long long lastImproveLevel = -1;
+	std::vector<LevelStats> levels;
+
+	void reset(){ total = LevelStats(); improvements = 0; lastImproveMove = lastImproveLevel = -1; levels.clear(); }
+};
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef KNAPSACK_ITEM_STORE_H
+#define KNAPSACK_ITEM_STORE_H
+
+// Armazenamento dos itens em colunas contíguas (structure-of-arrays), alinhadas
+// em 64 bytes: profit[], weight[] e order[] ocupam um único bloco.
+// Substitui o antigo long long **itens (uma linha malloc'ada por item), de modo
+// que as avaliações completas viram leituras sequenciais sobre as colunas.
+
+#include <stdlib.h> // posix_memalign, free
+#include <algorithm> // std::sort, std::swap
+#include "instrument.h" // KNAPSA_PHASE (só com -DKNAPSA_INSTRUMENT)
+#if defined(_WIN32)
+#include <malloc.h> // _aligned_malloc
+#endif
+
+// a tem razão estritamente maior que b (p_a/w_a > p_b/w_b, sem divisão)
+inline bool ratioGreater(long long pa, long long wa, long long pb, long long wb){
+	return static_cast<__int128>(pa) * wb > static_cast<__int128>(pb) * wa;
+}
+
+// Ordem total da gulosa: razão lucro/peso decrescente comparada de forma exata
+// (multiplicação cruzada em 128 bits); empate: maior lucro, menor peso, menor índice.
+// Sendo total, qualquer seleção parcial por ela reproduz a ordenação completa.
+inline bool ratioBefore(const long long *p, const long long *w, int a, int b){
+	if(ratioGreater(p[a], w[a], p[b], w[b])) return true;
+	if(ratioGreater(p[b], w[b], p[a], w[a])) return false;
+	if(p[a] != p[b]) return p[a] > p[b];
+	if(w[a] != w[b]) return w[a] < w[b];
+	return a < b;
+}
+
+struct ItemStore {
+	int n = 0;              // número de itens
+	long long *profit = nullptr; // profit[i]: lucro do item i
+	long long *weight = nullptr; // weight[i]: peso do item i
+	int *order = nullptr;        // permutação por ratioBefore; válida só depois de ratioOrder()
+	mutable bool orderReady = false;
+	void *block = nullptr;
+	int reserved = 0;            // itens que cabem no bloco atual (reaproveitado entre instâncias)
+
+	ItemStore() = default;
+	ItemStore(const ItemStore&) = delete;
+	ItemStore& operator=(const ItemStore&) = delete;
+	~ItemStore(){ release(); }
+
+	static size_t padded(size_t bytes){ return (bytes + 63) & ~static_cast<size_t>(63); }
+
+	// Aloca as colunas para count itens (conteúdo indefinido até ser preenchido).
+	// Se o bloco atual já comporta count itens ele é reaproveitado, sem nova alocação.
+	bool resize(int count){
+		if(count < 0) return false;
+		if(block != nullptr && count <= reserved){
+			n = count;
+			return true;
+		}
+		release();
+		size_t cols = padded(sizeof(long long) * count) * 2 + padded(sizeof(int) * count);
+		if(cols == 0) cols = 64;
+#if defined(_WIN32)
+		block = _aligned_malloc(cols, 64);
+#else
+		if(posix_memalign(&block, 64, cols) != 0) block = nullptr;
+#endif
+		if(block == nullptr) return false;
+		char *p = static_cast<char*>(block);
+		profit = reinterpret_cast<long long*>(p); p += padded(sizeof(long long) * count);
+		weight = reinterpret_cast<long long*>(p); p += padded(sizeof(long long) * count);
+		order  = reinterpret_cast<int*>(p);
+		n = count;
+		reserved = count;
+		return true;
+	}
+
+	// Chamado depois que profit/weight foram lidos: invalida a permutação da instância
+	// anterior. A ordenação completa não é feita aqui — a gulosa (greedy.h) só precisa
+	// do item crítico e de parte da cauda.
+	void finalize(){ orderReady = false; }
+
+	// Itens por ratioBefore, ordenados na primeira chamada e guardados até a próxima
+	// leitura (limites, redução e branch-and-bound reutilizam a mesma permutação).
+	// Não é seguro chamar pela primeira vez de várias threads ao mesmo tempo.
+	const int *ratioOrder() const {
+		if(!orderReady){
+			KNAPSA_PHASE(PHASE_SORT);
+			const long long *pr = profit, *wt = weight;
+			for(int i=0; i<n; ++i) order[i] = i;
+			std::sort(order, order + n, [pr, wt](int a, int b){ return ratioBefore(pr, wt, a, b); });
+			orderReady = true;
+		}
+		return order;
+	}
+
+	// Troca o conteúdo com outro store (sem cópia dos itens)
+	void swap(ItemStore &o){
+		std::swap(n, o.n); std::swap(profit, o.profit); std::swap(weight, o.weight);
+		std::swap(order, o.order); std::swap(orderReady, o.orderReady);
+		std::swap(block, o.block); std::swap(reserved, o.reserved);
+	}
+
+	void release(){
+		if(block != nullptr){
+#if defined(_WIN32)
+			_aligned_free(block);
+#else
+			free(block);
+#endif
+		}
+		block = nullptr; profit = nullptr; weight = nullptr; order = nullptr; orderReady = false; n = 0; reserved = 0;
+	}
+};
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef KNAPSACK_JOURNAL_H
+#define KNAPSACK_JOURNAL_H
+
+// Diário de uma varredura em lote: um registro por instância concluída, só
+// acrescentado ao fim, para retomar a varredura (--resume) e juntar os diários de
+// várias execuções ou fatias no CSV final (--merge).
+//
+// Uma linha por registro, campos separados por tabulação:
+//   config  status  rótulo  conteúdo  verificação
+// config identifica a configuração (versão, parâmetros e semente), status é ok, fail
+// ou timeout, conteúdo é a linha CSV (ok) ou o motivo da falha, e verificação é o
+// hash da linha até ali. Cada registro vai para o sistema operacional na hora
+// (fflush: uma queda do processo não perde nada) e para o disco em lotes (fsync a
+// cada syncEvery registros ou syncMs ms, e no fechamento). Uma queda da máquina
+// pode cortar a última linha; a leitura ignora linhas com verificação errada e a
+// última se não terminar em '\n', e open() corta o arquivo depois do último registro
+// válido antes de acrescentar.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+#if defined(_WIN32)
+#include <io.h> // _commit
+#else
+#include <unistd.h> // fsync
+#endif
+#include "hash128.h"
+
+struct JournalEntry {
+	std::string config, status, label, payload;
+};
+
+inline uint64_t journalCheck(const char *line, size_t bytes){
+	Hash128 h;
+	h.add(line, bytes);
+	return h.lo;
+}
+
+// Lê os registros válidos de path; validBytes recebe o fim do último registro válido
+// (de onde acrescentar). false se o arquivo não puder ser aberto.
+inline bool readJournal(const char *path, std::vector<JournalEntry> &entries, long long *validBytes = nullptr){
+	FILE *f = fopen(path, "rb");
+	if(f == NULL) return false;
+	std::string line;
+	long long pos = 0, valid = 0;
+	int c;
+	for(;;){
+		line.clear();
+		while((c = fgetc(f)) != EOF && c != '\n') line.push_back(static_cast<char>(c));
+		if(c == EOF) break; // sem '\n': registro cortado (ou fim do arquivo)
+		pos += static_cast<long long>(line.size()) + 1;
+		size_t cut = line.rfind('\t'); // linha completa mas inválida: pula
+		if(cut == std::string::npos || strtoull(line.c_str() + cut + 1, nullptr, 16) != journalCheck(line.data(), cut)) continue;
+		JournalEntry e;
+		size_t a = line.find('\t'), b = line.find('\t', a + 1), d = line.find('\t', b + 1);
+		if(d == std::string::npos || d > cut) continue;
+		e.config.assign(line, 0, a);
+		e.status.assign(line, a + 1, b - a - 1);
+		e.label.assign(line, b + 1, d - b - 1);
+		if(d < cut) e.payload.assign(line, d + 1, cut - d - 1);
+		entries.push_back(std::move(e));
+		valid = pos;
+	}
+	fclose(f);
+	if(validBytes) *validBytes = valid;
+	return true;
+}
+
+struct Journal {
+	FILE *out = NULL;
+	int syncEvery = 32;       // registros entre dois fsync
+	long long syncMs = 2000;  // tempo máximo entre dois fsync
+	int pending = 0;          // registros ainda sem fsync
+	std::chrono::steady_clock::time_point lastSync;
+	std::string line;
+
+	Journal() = default;
+	Journal(const Journal&) = delete;
+	Journal& operator=(const Journal&) = delete;
+	~Journal(){ close(); }
+
+	bool isOpen() const { return out != NULL; }
+
+	// Abre path para acrescentar (cria se não existir); entries (opcional) recebe os
+	// registros já gravados
+	bool open(const char *path, std::vector<JournalEntry> *entries = nullptr){
+		close();
+		std::vector<JournalEntry> local;
+		long long valid = 0;
+		std::error_code ec;
+		if(readJournal(path, entries ? *entries : local, &valid) &&
+		   static_cast<long long>(std::filesystem::file_size(path, ec)) != valid)
+			std::filesystem::resize_file(path, static_cast<uintmax_t>(valid), ec); // corta o registro incompleto
+		if(ec) return false;
+		out = fopen(path, "ab");
+		lastSync = std::chrono::steady_clock::now();
+		return out != NULL;
+	}
+
+	void append(const std::string &config, const char *status, const char *label, const char *payload){
+		if(out == NULL) return;
+		line.assign(config).append("\t").append(status).append("\t").append(label).append("\t");
+		for(const char *p = payload; *p; ++p) line.push_back((*p == '\t' || *p == '\n') ? ' ' : *p);
+		char check[24];
+		snprintf(check, sizeof(check), "\t%016llx\n", (unsigned long long)journalCheck(line.data(), line.size()));
+		line.append(check);
+		fwrite(line.data(), 1, line.size(), out);
+		fflush(out);
+		++pending;
+		if(pending >= syncEvery || std::chrono::steady_clock::now() - lastSync >= std::chrono::milliseconds(syncMs))
+			sync();
+	}
+
+	void sync(){
+		if(out == NULL || pending == 0) return;
+		fflush(out);
+#if defined(_WIN32)
+		_commit(_fileno(out));
+#else
+		fsync(fileno(out));
+#endif
+		pending = 0;
+		lastSync = std::chrono::steady_clock::now();
+	}
+
+	void close(){
+		if(out == NULL) return;
+		sync();
+		fclose(out);
+		out = NULL;
+	}
+};
+
+#endif
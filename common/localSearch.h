@@ -0,0 +1,108 @@
+#ifndef KNAPSACK_LOCAL_SEARCH_H
+#define KNAPSACK_LOCAL_SEARCH_H
+
+// Busca local entre a gulosa e o SA: troca 1-1 de melhor melhora (sai um item
+// selecionado, entra um não selecionado que caiba na folga + peso do que sai) seguida
+// de preenchimento pela ordem de razão, até não haver troca que aumente o lucro.
+// Para cada item que sai, o melhor que entra é o de maior lucro entre os de peso até
+// a folga: os não selecionados ficam em ordem de peso com o máximo de prefixo do
+// lucro, e a consulta é uma busca binária. Cada rodada custa O(n + k log n).
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "itemStore.h"
+#include "solution.h"
+
+struct LocalSearchScratch {
+	std::vector<int> byWeight;        // todos os itens por peso crescente (uma vez por instância)
+	std::vector<long long> inWeight;  // não selecionados, por peso
+	std::vector<int> inBest;          // inBest[k] = não selecionado de maior lucro em inWeight[0..k]
+	std::vector<int> fit;             // não selecionados que cabem na folga (preenchimento)
+};
+
+struct LocalSearchResult {
+	long long profit = 0, weight = 0;
+	int swaps = 0, fills = 0; // trocas aplicadas e itens acrescentados no preenchimento
+};
+
+// Acrescenta, pela ordem de razão, os itens não selecionados que ainda cabem. Só os
+// que cabem na folga inicial podem entrar (a folga só diminui), então só eles são
+// ordenados, como na cauda da gulosa: a permutação completa (ratioOrder) não é pedida.
+inline int fillByRatio(const ItemStore &it, long long capacity, Solution &sol, long long &profit, long long &weight,
+                       std::vector<int> &fit){
+	const long long *p = it.profit, *w = it.weight;
+	long long slack = capacity - weight;
+	fit.clear();
+	for(int i=0; i<it.n; ++i) if(!sol.get(i) && w[i] <= slack) fit.push_back(i);
+	std::sort(fit.begin(), fit.end(), [p, w](int a, int b){ return ratioBefore(p, w, a, b); });
+	int added = 0;
+	for(int i : fit){
+		if(weight + w[i] <= capacity){
+			sol.set(i, true);
+			weight += w[i];
+			profit += p[i];
+			++added;
+		}
+	}
+	return added;
+}
+
+inline int fillByRatio(const ItemStore &it, long long capacity, Solution &sol, long long &profit, long long &weight){
+	std::vector<int> fit;
+	return fillByRatio(it, capacity, sol, profit, weight, fit);
+}
+
+// Melhora sol (viável) por trocas 1-1 e preenchimento; maxRounds = 0 vai até o ótimo local
+inline LocalSearchResult improveBySwaps(const ItemStore &it, long long capacity, Solution &sol,
+                                        LocalSearchScratch &s, int maxRounds = 0){
+	const long long *p = it.profit, *w = it.weight;
+	int n = it.n;
+	LocalSearchResult r;
+	solutionTotals(it, sol, r.profit, r.weight);
+	if(r.weight > capacity) return r;
+	r.fills += fillByRatio(it, capacity, sol, r.profit, r.weight, s.fit);
+
+	s.byWeight.resize(n);
+	for(int i=0; i<n; ++i) s.byWeight[i] = i;
+	std::sort(s.byWeight.begin(), s.byWeight.end(), [w](int a, int b){ return w[a] < w[b] || (w[a] == w[b] && a < b); });
+
+	for(int round=0; maxRounds <= 0 || round < maxRounds; ++round){
+		s.inWeight.clear(); s.inBest.clear();
+		for(int i : s.byWeight){
+			if(sol.get(i)) continue;
+			int best = (s.inBest.empty() || p[i] > p[s.inBest.back()]) ? i : s.inBest.back();
+			s.inWeight.push_back(w[i]);
+			s.inBest.push_back(best);
+		}
+		if(s.inWeight.empty()) break;
+		long long slack = capacity - r.weight;
+		long long bestGain = 0;
+		int out = -1, in = -1;
+		for(int k=0; k<sol.words; ++k){
+			uint64_t bits = sol.bits[k];
+			while(bits){
+				int i = k * 64 + __builtin_ctzll(bits);
+				bits &= bits - 1;
+				long long room = slack + w[i];
+				int pos = static_cast<int>(std::upper_bound(s.inWeight.begin(), s.inWeight.end(), room) - s.inWeight.begin()) - 1;
+				if(pos < 0) continue;
+				int j = s.inBest[pos];
+				long long gain = p[j] - p[i];
+				if(gain > bestGain || (gain == bestGain && gain > 0 && w[j] - w[i] < w[in] - w[out])){
+					bestGain = gain; out = i; in = j;
+				}
+			}
+		}
+		if(out < 0) break; // ótimo local
+		sol.set(out, false);
+		sol.set(in, true);
+		r.profit += bestGain;
+		r.weight += w[in] - w[out];
+		++r.swaps;
+		r.fills += fillByRatio(it, capacity, sol, r.profit, r.weight, s.fit);
+	}
+	return r;
+}
+
+#endif
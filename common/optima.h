@@ -0,0 +1,102 @@
+#ifndef KNAPSACK_OPTIMA_H
+#define KNAPSACK_OPTIMA_H
+
+// Ótimos conhecidos (optima.csv: name,optimum; -1 = desconhecido), carregados uma vez
+// em uma tabela hash pelo nome do diretório da instância, e o resumo de qualidade
+// (gap até o ótimo, ótimos atingidos, tempo) por classe de instância e algoritmo.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "instanceParams.h"
+
+struct OptimaTable {
+	std::unordered_map<std::string, long long> byName;
+
+	// Lê "name,optimum" por linha (cabeçalho e linhas malformadas são ignorados);
+	// false se o arquivo não abrir
+	bool load(const char *path){
+		FILE *f = fopen(path, "r");
+		if(f == NULL) return false;
+		char line[512];
+		while(fgets(line, sizeof(line), f)){
+			char *comma = strchr(line, ',');
+			if(comma == NULL) continue;
+			char *end;
+			long long value = strtoll(comma + 1, &end, 10);
+			if(end == comma + 1) continue; // cabeçalho
+			byName[std::string(line, comma)] = value;
+		}
+		fclose(f);
+		return true;
+	}
+
+	// Ótimo da instância (nome do diretório); -1 se desconhecido
+	long long find(const std::string &name) const {
+		auto it = byName.find(name);
+		return it == byName.end() ? -1 : it->second;
+	}
+
+	size_t size() const { return byName.size(); }
+};
+
+// Distância percentual até o ótimo
+inline double gapPercent(long long optimum, long long profit){
+	return optimum > 0 ? 100.0 * static_cast<double>(optimum - profit) / static_cast<double>(optimum) : 0.0;
+}
+
+// Classe da instância: "n_<n>_c_<c>" (o prefixo do nome do diretório)
+inline std::string instanceClass(const std::string &name){
+	InstanceParams p;
+	if(!parseInstanceParams(name.c_str(), p)) return "desconhecida";
+	char buf[64];
+	snprintf(buf, sizeof(buf), "n_%d_c_%lld", p.n, p.c);
+	return buf;
+}
+
+// Acumula os resultados por (classe, algoritmo)
+struct QualitySummary {
+	struct Cell {
+		int instances = 0, known = 0, hits = 0;
+		double gapSum = 0.0, gapMax = 0.0, msSum = 0.0;
+	};
+	std::map<std::pair<std::string, std::string>, Cell> cells;
+
+	void add(const std::string &cls, const char *algorithm, long long optimum, long long profit, double ms){
+		Cell &c = cells[{cls, algorithm}];
+		++c.instances;
+		c.msSum += ms;
+		if(optimum < 0) return;
+		double gap = gapPercent(optimum, profit);
+		++c.known;
+		c.hits += (profit >= optimum);
+		c.gapSum += gap;
+		c.gapMax = std::max(c.gapMax, gap);
+	}
+
+	// CSV: classe,algoritmo,instancias,com_otimo,otimos_atingidos,gap_medio_pct,gap_max_pct,tempo_medio_ms
+	// (linhas "total" por algoritmo ao final)
+	void write(FILE *out) const {
+		fprintf(out, "classe,algoritmo,instancias,com_otimo,otimos_atingidos,gap_medio_pct,gap_max_pct,tempo_medio_ms\n");
+		std::map<std::string, Cell> totals;
+		for(const auto &kv : cells){
+			writeRow(out, kv.first.first.c_str(), kv.first.second.c_str(), kv.second);
+			Cell &t = totals[kv.first.second];
+			t.instances += kv.second.instances; t.known += kv.second.known; t.hits += kv.second.hits;
+			t.gapSum += kv.second.gapSum; t.gapMax = std::max(t.gapMax, kv.second.gapMax); t.msSum += kv.second.msSum;
+		}
+		for(const auto &kv : totals) writeRow(out, "total", kv.first.c_str(), kv.second);
+	}
+
+	static void writeRow(FILE *out, const char *cls, const char *algorithm, const Cell &c){
+		fprintf(out, "%s,%s,%d,%d,%d,%.6f,%.6f,%.3f\n", cls, algorithm, c.instances, c.known, c.hits,
+		        c.known ? c.gapSum / c.known : 0.0, c.gapMax, c.instances ? c.msSum / c.instances : 0.0);
+	}
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef KNAPSACK_RANDOM_H
+#define KNAPSACK_RANDOM_H
+
+// Gerador pseudoaleatório dos solvers: xoshiro256++ (Blackman & Vigna), semeado
+// por splitmix64. Estado de 32 bytes, sem estado global e sem objetos de
+// distribuição: inteiros em [0, n) pelo método de Lemire (sem viés e sem divisão
+// no caso comum) e doubles uniformes de 53 bits, avulsos ou em lote.
+//
+// Fluxos independentes e reprodutíveis:
+//  - jump() avança 2^128 passos: a cadeia k usa o gerador da semente após k saltos;
+//  - streamSeed(seed, id) deriva sementes distintas por instância/thread.
+
+#include <stdint.h>
+
+// Um passo do splitmix64 (também usado para misturar sementes)
+inline uint64_t splitmix64(uint64_t &x){
+	uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+// Semente do fluxo id derivada de seed (ex.: uma por instância de um lote)
+inline uint64_t streamSeed(uint64_t seed, uint64_t id){
+	uint64_t x = seed ^ (id * 0xD1B54A32D192ED03ULL);
+	splitmix64(x);
+	return splitmix64(x);
+}
+
+struct Rng {
+	uint64_t s[4];
+
+	explicit Rng(uint64_t seedValue = 42){ seed(seedValue); }
+
+	void seed(uint64_t seedValue){
+		uint64_t x = seedValue;
+		for(int k=0; k<4; ++k) s[k] = splitmix64(x); // nunca todo zero
+	}
+
+	static uint64_t rotl(uint64_t x, int k){ return (x << k) | (x >> (64 - k)); }
+
+	uint64_t next(){
+		uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+		uint64_t t = s[1] << 17;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = rotl(s[3], 45);
+		return result;
+	}
+
+	// Avança 2^128 passos (fluxos que não se sobrepõem a partir da mesma semente)
+	void jump(){
+		static const uint64_t JUMP[4] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+		uint64_t t[4] = {0, 0, 0, 0};
+		for(int i=0; i<4; ++i)
+			for(int b=0; b<64; ++b){
+				if(JUMP[i] & (1ULL << b)){ t[0] ^= s[0]; t[1] ^= s[1]; t[2] ^= s[2]; t[3] ^= s[3]; }
+				next();
+			}
+		s[0] = t[0]; s[1] = t[1]; s[2] = t[2]; s[3] = t[3];
+	}
+
+	// Inteiro uniforme em [0, n), n > 0 (Lemire: multiplicação 32x32 e rejeição rara)
+	uint32_t below(uint32_t n){
+		uint64_t m = (next() >> 32) * static_cast<uint64_t>(n);
+		uint32_t low = static_cast<uint32_t>(m);
+		if(low < n){
+			uint32_t threshold = static_cast<uint32_t>(-n) % n;
+			while(low < threshold){
+				m = (next() >> 32) * static_cast<uint64_t>(n);
+				low = static_cast<uint32_t>(m);
+			}
+		}
+		return static_cast<uint32_t>(m >> 32);
+	}
+
+	// Uniforme em [0, 1) com 53 bits
+	double uniform(){ return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); } // 2^-53
+	// Uniforme em (0, 1]: seguro para log()
+	double uniformOpen(){ return static_cast<double>((next() >> 11) + 1) * (1.0 / 9007199254740992.0); }
+
+	// Lote de count uniformes em (0, 1] (para pré-calcular limiares de aceitação)
+	void fillUniformOpen(double *out, int count){
+		for(int i=0; i<count; ++i) out[i] = uniformOpen();
+	}
+};
+
+#endif
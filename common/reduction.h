@@ -0,0 +1,120 @@
+#ifndef KNAPSACK_REDUCTION_H
+#define KNAPSACK_REDUCTION_H
+
+// Redução do problema antes de qualquer solver: a instância vira um núcleo menor
+// (itens livres, renumerados, com a capacidade residual) mais os itens fixados.
+//  1. Itens mais pesados que a capacidade saem.
+//  2. Fixação por limite (fixByBounds, common/bounds.h) contra a incumbente de lucro
+//     lb: ficam fora os itens que não estão em nenhuma solução melhor que lb e
+//     dentro os que estão em todas.
+//  3. Dominância: i domina j se w_i <= w_j e p_i >= p_j (empate exato: menor índice).
+//     Trocando j por i nunca se perde, então há uma solução ótima em que j dentro
+//     implica todos os que o dominam dentro; se o peso deles mais w_j passa da
+//     capacidade residual, j fica fora. O peso dos dominantes sai de uma árvore de
+//     Fenwick sobre o lucro, percorrendo os itens por peso crescente.
+// O ótimo da instância é max(lb, lucro fixado + ótimo do núcleo); expand() monta a
+// solução completa a partir de uma solução do núcleo.
+
+#include <algorithm>
+#include <vector>
+#include "itemStore.h"
+#include "solution.h"
+#include "bounds.h"
+
+struct ReducedProblem {
+	ItemStore core;                  // itens livres, em ordem de razão decrescente
+	std::vector<int> original;       // original[k] = índice na instância do item k do núcleo
+	std::vector<signed char> fixed;  // por item da instância: 1 dentro, 0 fora, -1 no núcleo
+	long long capacity = 0;          // capacidade residual (capacidade - peso fixado em 1)
+	long long fixedProfit = 0;       // lucro dos itens fixados em 1
+	long long upperBound = -1;       // limite de Dantzig da instância (ou lb, se maior)
+	bool closed = false;             // o peso fixado em 1 passa da capacidade: a incumbente é ótima
+	int heavy = 0, boundOut = 0, boundIn = 0, dominated = 0; // itens tirados por regra
+
+	int n() const { return core.n; }
+
+	// Solução completa: fixados em 1 mais os itens marcados em coreSol
+	void expand(const Solution &coreSol, Solution &full) const {
+		full.resize(static_cast<int>(fixed.size()));
+		for(size_t i=0; i<fixed.size(); ++i) if(fixed[i] == 1) full.set(static_cast<int>(i), true);
+		for(int k=0; k<core.n; ++k) if(coreSol.get(k)) full.set(original[k], true);
+	}
+
+	// Parte de uma solução da instância que cai no núcleo (ex.: a incumbente como partida)
+	void restrict(const Solution &full, Solution &coreSol) const {
+		coreSol.resize(core.n);
+		for(int k=0; k<core.n; ++k) if(full.get(original[k])) coreSol.set(k, true);
+	}
+};
+
+// Fixa em 0 os livres dominados cujo conjunto de dominantes (livres) não cabe junto
+// com eles em residual; devolve quantos foram fixados
+inline int fixDominated(const ItemStore &it, long long residual, std::vector<signed char> &fixed){
+	const long long *p = it.profit, *w = it.weight;
+	std::vector<int> items;
+	for(int i=0; i<it.n; ++i) if(fixed[i] < 0) items.push_back(i);
+	int m = static_cast<int>(items.size());
+	if(m == 0) return 0;
+	// posto do lucro em ordem decrescente (1 = maior), para somar "lucro >= p_j"
+	std::vector<long long> profits(m);
+	for(int k=0; k<m; ++k) profits[k] = p[items[k]];
+	std::sort(profits.begin(), profits.end(), [](long long a, long long b){ return a > b; });
+	profits.erase(std::unique(profits.begin(), profits.end()), profits.end());
+	auto rankOf = [&profits](long long v){
+		return static_cast<int>(std::lower_bound(profits.begin(), profits.end(), v, [](long long a, long long b){ return a > b; }) - profits.begin()) + 1;
+	};
+	// por peso crescente; empate: maior lucro, menor índice (os anteriores dominam)
+	std::sort(items.begin(), items.end(), [p, w](int a, int b){
+		if(w[a] != w[b]) return w[a] < w[b];
+		if(p[a] != p[b]) return p[a] > p[b];
+		return a < b;
+	});
+	std::vector<long long> tree(profits.size() + 1, 0); // Fenwick: peso por posto de lucro
+	int count = 0;
+	for(int j : items){
+		int r = rankOf(p[j]);
+		long long dominators = 0; // peso dos anteriores com lucro >= p_j
+		for(int k=r; k>0; k -= k & -k) dominators += tree[k];
+		if(dominators + w[j] > residual){ fixed[j] = 0; ++count; }
+		for(int k=r; k<static_cast<int>(tree.size()); k += k & -k) tree[k] += w[j];
+	}
+	return count;
+}
+
+// Reduz (it, capacity) com a incumbente de lucro lb; dominance = false pula o passo 3
+inline void reduceProblem(const ItemStore &it, long long capacity, long long lb, ReducedProblem &red, bool dominance = true){
+	int n = it.n;
+	RatioPrefix rp;
+	rp.build(it);
+	red.upperBound = std::max(rp.dantzig(it, capacity), lb);
+	red.heavy = red.boundOut = red.boundIn = red.dominated = 0;
+	red.closed = false;
+	fixByBounds(it, rp, capacity, lb, red.fixed);
+	long long residual = capacity, fixedProfit = 0;
+	for(int i=0; i<n; ++i){
+		if(it.weight[i] > capacity){ ++red.heavy; continue; }
+		if(red.fixed[i] == 0) ++red.boundOut;
+		else if(red.fixed[i] == 1){ ++red.boundIn; residual -= it.weight[i]; fixedProfit += it.profit[i]; }
+	}
+	red.capacity = residual;
+	red.fixedProfit = fixedProfit;
+	red.original.clear();
+	if(residual < 0){ // nenhuma solução melhor que lb
+		red.closed = true;
+		red.upperBound = lb;
+		red.core.resize(0);
+		red.core.finalize();
+		return;
+	}
+	if(dominance) red.dominated = fixDominated(it, residual, red.fixed);
+	for(int k=0; k<n; ++k) if(red.fixed[rp.order[k]] < 0) red.original.push_back(rp.order[k]);
+	int m = static_cast<int>(red.original.size());
+	red.core.resize(m);
+	for(int k=0; k<m; ++k){
+		red.core.profit[k] = it.profit[red.original[k]];
+		red.core.weight[k] = it.weight[red.original[k]];
+	}
+	red.core.finalize();
+}
+
+#endif
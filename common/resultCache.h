@@ -0,0 +1,234 @@
+#ifndef KNAPSACK_RESULT_CACHE_H
+#define KNAPSACK_RESULT_CACHE_H
+
+// Cache de resultados em disco, endereçado pelo conteúdo: a chave é um hash de 128
+// bits de (itens e capacidade da instância, versão do solver, algoritmo, conjunto de
+// parâmetros, semente), então a mesma instância em texto, .knpb ou .knpa cai na mesma
+// entrada, e qualquer mudança de parâmetro ou de versão vira outra chave.
+//
+// Arquivo (little-endian, registros alinhados em 8 bytes, lido por mmap):
+//   ResultCacheHeader (64 bytes)
+//   ResultCacheRecord (104 bytes) + words palavras da solução, repetidos
+// Registros novos são acrescentados ao fim (fflush a cada um). Ao abrir, um registro
+// final incompleto (processo interrompido) ou de outra versão do solver é descartado
+// reescrevendo o arquivo; o mesmo acontece com os dos conjuntos de parâmetros invalidados.
+// Um processo por arquivo: escritas concorrentes não são coordenadas.
+
+#include <stddef.h> // offsetof
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm> // std::find
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "itemStore.h"
+#include "solution.h"
+#include "instanceReader.h" // MappedFile
+#include "hash128.h"
+
+// Conteúdo da instância: n, capacidade e as colunas profit/weight
+inline Hash128 instanceHash(const ItemStore &it, long long capacity){
+	Hash128 h;
+	h.add(static_cast<uint64_t>(it.n));
+	h.add(static_cast<uint64_t>(capacity));
+	h.add(it.profit, sizeof(long long) * it.n);
+	h.add(it.weight, sizeof(long long) * it.n);
+	return h;
+}
+
+// Resultado de uma instância (o que a linha CSV mostra)
+struct RunRecord {
+	int algorithm = 0;           // definido pelo solver (ex.: sa, dp, bb, portfolio)
+	int engine = 0;              // idem: quem achou a solução (--portfolio)
+	int status = 0;              // idem (ex.: optimal, memory_limit, budget)
+	long long greedyProfit = 0;
+	long long profit = 0;
+	long long upperBound = -1;
+	long long greedyMs = 0, solveMs = 0;
+	double bestMs = 0.0;         // tempo até a melhor solução
+};
+
+static const char RESULT_CACHE_MAGIC[4] = {'K', 'N', 'P', 'C'};
+static const char RESULT_RECORD_MAGIC[4] = {'K', 'N', 'P', 'R'};
+static const uint32_t RESULT_CACHE_FORMAT = 2;
+
+struct ResultCacheHeader {
+	char magic[4];
+	uint32_t format;
+	uint64_t reserved[7];
+};
+
+struct ResultCacheRecord {
+	char magic[4];           // "KNPR"
+	uint32_t version;        // versão do solver que gravou
+	uint64_t key[2];         // Hash128 da chave
+	uint64_t paramHash;      // conjunto de parâmetros (sem a semente)
+	uint32_t seed;
+	uint8_t algorithm, engine;
+	uint16_t status;
+	uint32_t n, words;       // itens; palavras da solução (0 = sem solução)
+	int64_t greedyProfit, profit, upperBound, greedyMs, solveMs;
+	double bestMs;
+	uint64_t check;          // hash do registro e da solução (detecta escrita parcial)
+};
+static_assert(sizeof(ResultCacheHeader) == 64, "cabeçalho do cache");
+static_assert(sizeof(ResultCacheRecord) == 104, "registro do cache");
+
+struct ResultCache {
+	std::string path;
+	uint32_t version = 0;
+	MappedFile file;
+	std::unordered_map<Hash128, const ResultCacheRecord*, Hash128Hasher> index;
+	std::vector<std::vector<uint64_t>> appended; // registros gravados nesta execução
+	FILE *out = NULL;
+	long long hits = 0, misses = 0, stored = 0;
+
+	ResultCache() = default;
+	ResultCache(const ResultCache&) = delete;
+	ResultCache& operator=(const ResultCache&) = delete;
+	~ResultCache(){ close(); }
+
+	bool isOpen() const { return out != NULL; }
+
+	static uint64_t recordCheck(const ResultCacheRecord &r, const uint64_t *words){
+		Hash128 h;
+		h.add(&r, offsetof(ResultCacheRecord, check));
+		h.add(words, sizeof(uint64_t) * r.words);
+		return h.lo;
+	}
+
+	// Abre (ou cria) o cache de path para a versão do solver, descartando os registros dos
+	// conjuntos de parâmetros em invalidParams. false se não abrir/criar.
+	bool open(const char *cachePath, uint32_t solverVersion, const std::vector<uint64_t> &invalidParams = {}){
+		close();
+		path = cachePath;
+		version = solverVersion;
+		std::error_code ec;
+		std::filesystem::path parent = std::filesystem::path(path).parent_path();
+		if(!parent.empty()) std::filesystem::create_directories(parent, ec);
+		if(!std::filesystem::exists(path, ec) && !writeFile(path, {})) return false;
+		if(!file.open(path.c_str())) return false;
+		std::vector<const ResultCacheRecord*> keep;
+		bool rewrite = !scan(keep, invalidParams);
+		if(rewrite){ // reescreve só com os registros válidos
+			std::vector<std::vector<uint64_t>> records;
+			for(const ResultCacheRecord *r : keep) records.push_back(recordWords(r));
+			file.close();
+			std::string tmp = path + ".tmp";
+			if(!writeFile(tmp, records)) return false;
+			std::filesystem::rename(tmp, path, ec);
+			if(ec || !file.open(path.c_str())) return false;
+			keep.clear();
+			scan(keep, {});
+		}
+		index.clear();
+		for(const ResultCacheRecord *r : keep) index[keyOf(r)] = r;
+		out = fopen(path.c_str(), "ab");
+		return out != NULL;
+	}
+
+	void close(){
+		if(out != NULL) fclose(out);
+		out = NULL;
+		index.clear();
+		appended.clear();
+		file.close();
+	}
+
+	// Registro da chave (nullptr se ausente); as palavras da solução vêm logo depois dele
+	const ResultCacheRecord *find(const Hash128 &key) const {
+		auto it = index.find(key);
+		return it == index.end() ? nullptr : it->second;
+	}
+	static const uint64_t *solutionWords(const ResultCacheRecord *r){
+		return reinterpret_cast<const uint64_t*>(r + 1);
+	}
+
+	// Acrescenta o resultado (sol opcional: a solução de lucro rec.profit)
+	bool store(const Hash128 &key, uint64_t paramHash, uint32_t seed, int n, const RunRecord &rec, const Solution *sol){
+		if(out == NULL) return false;
+		ResultCacheRecord r;
+		memset(&r, 0, sizeof(r));
+		memcpy(r.magic, RESULT_RECORD_MAGIC, 4);
+		r.version = version;
+		r.key[0] = key.lo; r.key[1] = key.hi;
+		r.paramHash = paramHash;
+		r.seed = seed;
+		r.algorithm = static_cast<uint8_t>(rec.algorithm);
+		r.engine = static_cast<uint8_t>(rec.engine);
+		r.status = static_cast<uint16_t>(rec.status);
+		r.n = static_cast<uint32_t>(n);
+		r.words = sol ? static_cast<uint32_t>(sol->words) : 0;
+		r.greedyProfit = rec.greedyProfit; r.profit = rec.profit; r.upperBound = rec.upperBound;
+		r.greedyMs = rec.greedyMs; r.solveMs = rec.solveMs; r.bestMs = rec.bestMs;
+		const uint64_t *words = sol ? sol->bits.data() : nullptr;
+		r.check = recordCheck(r, words);
+		std::vector<uint64_t> buf((sizeof(r) + sizeof(uint64_t) * r.words) / sizeof(uint64_t));
+		memcpy(buf.data(), &r, sizeof(r));
+		if(r.words) memcpy(buf.data() + sizeof(r) / sizeof(uint64_t), words, sizeof(uint64_t) * r.words);
+		if(fwrite(buf.data(), sizeof(uint64_t), buf.size(), out) != buf.size()) return false;
+		fflush(out);
+		appended.push_back(std::move(buf));
+		index[key] = reinterpret_cast<const ResultCacheRecord*>(appended.back().data());
+		++stored;
+		return true;
+	}
+
+	static RunRecord toRunRecord(const ResultCacheRecord *r){
+		RunRecord rec;
+		rec.algorithm = r->algorithm; rec.engine = r->engine; rec.status = r->status;
+		rec.greedyProfit = r->greedyProfit; rec.profit = r->profit; rec.upperBound = r->upperBound;
+		rec.greedyMs = r->greedyMs; rec.solveMs = r->solveMs; rec.bestMs = r->bestMs;
+		return rec;
+	}
+
+private:
+	static Hash128 keyOf(const ResultCacheRecord *r){ Hash128 h; h.lo = r->key[0]; h.hi = r->key[1]; return h; }
+
+	static std::vector<uint64_t> recordWords(const ResultCacheRecord *r){
+		std::vector<uint64_t> buf((sizeof(*r) + sizeof(uint64_t) * r->words) / sizeof(uint64_t));
+		memcpy(buf.data(), r, sizeof(uint64_t) * buf.size());
+		return buf;
+	}
+
+	// Percorre os registros do mapeamento; false se o arquivo precisa ser reescrito
+	// (cabeçalho inválido, final incompleto, versão antiga ou parâmetros invalidados)
+	bool scan(std::vector<const ResultCacheRecord*> &keep, const std::vector<uint64_t> &invalidParams){
+		if(file.size < sizeof(ResultCacheHeader) || memcmp(file.data, RESULT_CACHE_MAGIC, 4) != 0) return false;
+		ResultCacheHeader h;
+		memcpy(&h, file.data, sizeof(h));
+		if(h.format != RESULT_CACHE_FORMAT) return false;
+		bool clean = true;
+		size_t pos = sizeof(ResultCacheHeader);
+		while(pos < file.size){
+			if(file.size - pos < sizeof(ResultCacheRecord)){ clean = false; break; }
+			const ResultCacheRecord *r = reinterpret_cast<const ResultCacheRecord*>(file.data + pos);
+			size_t bytes = sizeof(ResultCacheRecord) + sizeof(uint64_t) * static_cast<size_t>(r->words);
+			if(memcmp(r->magic, RESULT_RECORD_MAGIC, 4) != 0 || file.size - pos < bytes ||
+			   recordCheck(*r, solutionWords(r)) != r->check){ clean = false; break; }
+			pos += bytes;
+			if(r->version != version || std::find(invalidParams.begin(), invalidParams.end(), r->paramHash) != invalidParams.end()){
+				clean = false;
+				continue;
+			}
+			keep.push_back(r);
+		}
+		return clean;
+	}
+
+	static bool writeFile(const std::string &fileName, const std::vector<std::vector<uint64_t>> &records){
+		FILE *f = fopen(fileName.c_str(), "wb");
+		if(f == NULL) return false;
+		ResultCacheHeader h;
+		memset(&h, 0, sizeof(h));
+		memcpy(h.magic, RESULT_CACHE_MAGIC, 4);
+		h.format = RESULT_CACHE_FORMAT;
+		bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+		for(const auto &r : records) ok = ok && fwrite(r.data(), sizeof(uint64_t), r.size(), f) == r.size();
+		return (fclose(f) == 0) && ok;
+	}
+};
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef KNAPSACK_SOLUTION_H
+#define KNAPSACK_SOLUTION_H
+
+// Solução 0-1 compactada em bits (1 bit por item, palavras de 64 bits).
+// Cópias, comparações e hash trabalham palavra a palavra (n/64 palavras), e a
+// avaliação completa mascara as colunas profit/weight do ItemStore pelos bits,
+// com kernels AVX-512/AVX2 quando o compilador os habilita (ex.: -march=native).
+//
+// Invariante: os bits acima de n na última palavra são sempre zero.
+
+#include <stdint.h> // uint64_t
+#include <string.h> // memcpy
+#include <vector>
+#include "itemStore.h"
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+struct Solution {
+	int n = 0;     // número de itens
+	int words = 0; // número de palavras de 64 bits
+	std::vector<uint64_t> bits;
+
+	Solution() = default;
+	explicit Solution(int count){ resize(count); }
+
+	// Redimensiona e zera (nenhum item selecionado)
+	void resize(int count){
+		n = count;
+		words = (count + 63) / 64;
+		bits.assign(words, 0);
+	}
+	void clear(){ if(words > 0) memset(bits.data(), 0, sizeof(uint64_t) * words); }
+
+	bool get(int i) const { return (bits[i >> 6] >> (i & 63)) & 1ULL; }
+	void set(int i, bool v){
+		uint64_t m = 1ULL << (i & 63);
+		if(v) bits[i >> 6] |= m; else bits[i >> 6] &= ~m;
+	}
+	void flip(int i){ bits[i >> 6] ^= 1ULL << (i & 63); }
+
+	// Cópia palavra a palavra (mesmo n)
+	void copyFrom(const Solution &o){
+		if(o.words != words){ bits.resize(o.words); words = o.words; }
+		n = o.n;
+		if(words > 0) memcpy(bits.data(), o.bits.data(), sizeof(uint64_t) * words);
+	}
+
+	// Número de itens selecionados
+	int count() const {
+		int c = 0;
+		for(int k=0; k<words; ++k) c += __builtin_popcountll(bits[k]);
+		return c;
+	}
+
+	// Distância de Hamming (popcount do XOR)
+	int diffCount(const Solution &o) const {
+		int c = 0;
+		for(int k=0; k<words; ++k) c += __builtin_popcountll(bits[k] ^ o.bits[k]);
+		return c;
+	}
+
+	// Chama f(i) para cada item i em que as duas soluções diferem
+	template<class F> void forEachDiff(const Solution &o, F f) const {
+		for(int k=0; k<words; ++k){
+			uint64_t d = bits[k] ^ o.bits[k];
+			while(d){
+				f(k * 64 + __builtin_ctzll(d));
+				d &= d - 1;
+			}
+		}
+	}
+
+	bool operator==(const Solution &o) const {
+		return n == o.n && (words == 0 || memcmp(bits.data(), o.bits.data(), sizeof(uint64_t) * words) == 0);
+	}
+	bool operator!=(const Solution &o) const { return !(*this == o); }
+
+	// Hash de 64 bits das palavras (mistura estilo splitmix64)
+	uint64_t hash() const {
+		uint64_t h = 0x9E3779B97F4A7C15ULL ^ static_cast<uint64_t>(n);
+		for(int k=0; k<words; ++k){
+			uint64_t x = bits[k] + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+			x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+			h ^= x ^ (x >> 31);
+		}
+		return h;
+	}
+};
+
+// Soma lucro e peso dos itens selecionados em sol.
+// Os kernels vetoriais leem blocos de 4/8 itens além de n; isso é seguro porque
+// o ItemStore completa cada coluna até múltiplos de 64 bytes (8 valores) e os
+// bits acima de n são zero (as faixas lidas são descartadas pela máscara).
+inline void solutionTotals(const ItemStore &it, const Solution &sol, long long &profit, long long &weight){
+	const uint64_t *b = sol.bits.data();
+#if defined(__AVX512F__)
+	__m512i accP = _mm512_setzero_si512(), accW = _mm512_setzero_si512();
+	int groups = (sol.n + 7) / 8;
+	for(int g=0; g<groups; ++g){
+		__mmask8 m = static_cast<__mmask8>(b[g >> 3] >> ((g & 7) * 8));
+		accP = _mm512_add_epi64(accP, _mm512_maskz_loadu_epi64(m, it.profit + g * 8));
+		accW = _mm512_add_epi64(accW, _mm512_maskz_loadu_epi64(m, it.weight + g * 8));
+	}
+	long long lp[8], lw[8];
+	_mm512_storeu_si512(lp, accP);
+	_mm512_storeu_si512(lw, accW);
+	profit = lp[0] + lp[1] + lp[2] + lp[3] + lp[4] + lp[5] + lp[6] + lp[7];
+	weight = lw[0] + lw[1] + lw[2] + lw[3] + lw[4] + lw[5] + lw[6] + lw[7];
+#elif defined(__AVX2__)
+	const __m256i sel = _mm256_set_epi64x(8, 4, 2, 1);
+	__m256i accP = _mm256_setzero_si256(), accW = _mm256_setzero_si256();
+	int quads = (sol.n + 3) / 4;
+	for(int q=0; q<quads; ++q){
+		long long nib = static_cast<long long>((b[q >> 4] >> ((q & 15) * 4)) & 0xF);
+		__m256i m = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(nib), sel), sel);
+		accP = _mm256_add_epi64(accP, _mm256_and_si256(m, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it.profit + q * 4))));
+		accW = _mm256_add_epi64(accW, _mm256_and_si256(m, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it.weight + q * 4))));
+	}
+	long long lp[4], lw[4];
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(lp), accP);
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(lw), accW);
+	profit = lp[0] + lp[1] + lp[2] + lp[3];
+	weight = lw[0] + lw[1] + lw[2] + lw[3];
+#else
+	long long p = 0, w = 0;
+	for(int k=0; k<sol.words; ++k){
+		uint64_t x = b[k];
+		while(x){
+			int i = k * 64 + __builtin_ctzll(x);
+			p += it.profit[i];
+			w += it.weight[i];
+			x &= x - 1;
+		}
+	}
+	profit = p;
+	weight = w;
+#endif
+}
+
+#endif
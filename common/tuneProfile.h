@@ -0,0 +1,115 @@
+#ifndef KNAPSACK_TUNE_PROFILE_H
+#define KNAPSACK_TUNE_PROFILE_H
+
+// Perfil de parâmetros do SA por classe de instância ("n_<n>_c_<c>", ver instanceClass),
+// escrito pelo tools/knapTune (corrida F-race) e carregado pelo solver com --profile.
+//
+// CSV de texto; linhas que começam com '#' são comentários (o knapTune registra nelas as
+// opções da corrida) e a primeira linha restante é o cabeçalho:
+//   classe,penalidade,aceitacao_inicial,aceitacao_final,fator_patamar,alpha,inicio,blocos,custo_medio
+// inicio é zero, greedy ou ls (mesma ordem do StartMode do Adrias); blocos e custo_medio
+// só documentam a corrida e não são usados na leitura.
+
+#include <stdio.h>
+#include <stdlib.h> // strtod
+#include <string.h>
+#include <map>
+#include <string>
+#include "hash128.h"
+
+static const char *const PROFILE_START_NAMES[] = {"zero", "greedy", "ls"};
+static const int PROFILE_START_COUNT = 3;
+
+// Parâmetros ajustáveis do SA (os padrões são os do solver)
+struct SAParams {
+	double penaltyFactor = 10.0;      // --penalty
+	double initialAcceptance = 0.3;   // --init-accept: aceitação de pioras no início (calibração)
+	double finalAcceptance = 0.001;   // --final-accept: e no fim
+	double levelFactor = 0.5;         // --level-factor: tentativas por patamar = fator * n
+	double alpha = 0.99;              // --alpha: resfriamento geométrico (sem orçamento)
+	int start = 2;                    // --start: índice em PROFILE_START_NAMES
+
+	// Faixas aceitas pelo solver
+	bool valid() const {
+		return penaltyFactor > 0.0 && finalAcceptance > 0.0 && initialAcceptance > finalAcceptance && initialAcceptance < 1.0 &&
+		       levelFactor > 0.0 && alpha > 0.0 && alpha < 1.0 && start >= 0 && start < PROFILE_START_COUNT;
+	}
+};
+
+struct ProfileEntry {
+	SAParams params;
+	int blocks = 0;         // blocos (instância, semente) avaliados na corrida
+	double meanCost = 0.0;  // custo médio do vencedor nesses blocos
+};
+
+struct ParamProfile {
+	std::map<std::string, ProfileEntry> byClass;
+
+	// Lê path; 0 se ok, -1 se o arquivo não abrir, ou o número da primeira linha inválida
+	int load(const char *path){
+		FILE *f = fopen(path, "r");
+		if(f == NULL) return -1;
+		byClass.clear();
+		char line[512];
+		int lineNo = 0;
+		bool header = true;
+		while(fgets(line, sizeof(line), f)){
+			++lineNo;
+			line[strcspn(line, "\r\n")] = '\0';
+			if(line[0] == '#' || line[0] == '\0') continue;
+			if(header){ header = false; continue; }
+			char cls[128], start[16];
+			ProfileEntry e;
+			SAParams &p = e.params;
+			int fields = sscanf(line, "%127[^,],%lf,%lf,%lf,%lf,%lf,%15[^,],%d,%lf", cls, &p.penaltyFactor, &p.initialAcceptance,
+			                    &p.finalAcceptance, &p.levelFactor, &p.alpha, start, &e.blocks, &e.meanCost);
+			p.start = -1;
+			for(int k=0; fields >= 7 && k<PROFILE_START_COUNT; ++k)
+				if(strcmp(start, PROFILE_START_NAMES[k]) == 0) p.start = k;
+			if(fields < 7 || !p.valid()){ fclose(f); return lineNo; }
+			byClass[cls] = e;
+		}
+		fclose(f);
+		return 0;
+	}
+
+	// Parâmetros da classe (nullptr se a classe não está no perfil)
+	const SAParams *find(const std::string &cls) const {
+		auto it = byClass.find(cls);
+		return it == byClass.end() ? nullptr : &it->second.params;
+	}
+
+	// Conteúdo que muda resultados (classes e parâmetros), para a configuração do diário
+	uint64_t digest() const {
+		Hash128 h;
+		for(const auto &kv : byClass){
+			const SAParams &p = kv.second.params;
+			h.add(kv.first.data(), kv.first.size() + 1);
+			double v[5] = {p.penaltyFactor, p.initialAcceptance, p.finalAcceptance, p.levelFactor, p.alpha};
+			h.add(v, sizeof(v));
+			h.add(static_cast<uint64_t>(p.start));
+		}
+		return h.lo ^ h.hi;
+	}
+
+	// Grava o perfil; comments vão antes do cabeçalho, uma linha '#' cada
+	bool write(FILE *out, const std::string &comments) const {
+		size_t pos = 0;
+		while(pos < comments.size()){
+			size_t end = comments.find('\n', pos);
+			if(end == std::string::npos) end = comments.size();
+			fprintf(out, "# %s\n", comments.substr(pos, end - pos).c_str());
+			pos = end + 1;
+		}
+		fprintf(out, "classe,penalidade,aceitacao_inicial,aceitacao_final,fator_patamar,alpha,inicio,blocos,custo_medio\n");
+		for(const auto &kv : byClass){
+			const ProfileEntry &e = kv.second;
+			const SAParams &p = e.params;
+			fprintf(out, "%s,%.6g,%.6g,%.6g,%.6g,%.6g,%s,%d,%.6g\n", kv.first.c_str(), p.penaltyFactor, p.initialAcceptance,
+			        p.finalAcceptance, p.levelFactor, p.alpha, PROFILE_START_NAMES[p.start], e.blocks, e.meanCost);
+		}
+		return ferror(out) == 0;
+	}
+};
+
+#endif
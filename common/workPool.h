@@ -0,0 +1,60 @@
+#ifndef KNAPSACK_WORK_POOL_H
+#define KNAPSACK_WORK_POOL_H
+
+// Pool de threads com roubo de trabalho (work stealing) para lotes de jobs independentes.
+// Os jobs são distribuídos em round-robin, na ordem dada, entre deques por thread:
+// cada thread consome a própria deque pela frente e, quando ela esvazia, rouba
+// pelo fundo das deques das outras. Passar a ordem "maiores primeiro" faz com que
+// os jobs caros comecem cedo e os pequenos sirvam para equilibrar o final.
+// Compilar com -pthread.
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Número de threads a usar: requested <= 0 significa "todos os núcleos"
+inline int resolveThreadCount(int requested){
+	if(requested > 0) return requested;
+	unsigned hw = std::thread::hardware_concurrency();
+	return hw > 0 ? static_cast<int>(hw) : 1;
+}
+
+// Executa job(jobIndex, threadIndex) para cada índice em order, usando nThreads threads.
+// Retorna quando todos terminarem. Com nThreads == 1 roda na própria thread chamadora.
+template<class Job>
+void runWorkStealing(const std::vector<int> &order, int nThreads, Job job){
+	if(nThreads < 1) nThreads = 1;
+	if(nThreads == 1 || order.size() <= 1){
+		for(int idx : order) job(idx, 0);
+		return;
+	}
+	struct Queue { std::mutex m; std::deque<int> q; };
+	std::vector<Queue> queues(nThreads);
+	for(size_t k=0; k<order.size(); ++k)
+		queues[k % nThreads].q.push_back(order[k]);
+
+	auto worker = [&](int self){
+		for(;;){
+			int idx = -1;
+			{ // própria deque: frente
+				std::lock_guard<std::mutex> lk(queues[self].m);
+				if(!queues[self].q.empty()){ idx = queues[self].q.front(); queues[self].q.pop_front(); }
+			}
+			for(int k=1; idx < 0 && k<nThreads; ++k){ // roubo: fundo das outras
+				Queue &victim = queues[(self + k) % nThreads];
+				std::lock_guard<std::mutex> lk(victim.m);
+				if(!victim.q.empty()){ idx = victim.q.back(); victim.q.pop_back(); }
+			}
+			if(idx < 0) return; // nada restante (jobs nunca são reenfileirados)
+			job(idx, self);
+		}
+	};
+	std::vector<std::thread> threads;
+	threads.reserve(nThreads - 1);
+	for(int t=1; t<nThreads; ++t) threads.emplace_back(worker, t);
+	worker(0);
+	for(auto &th : threads) th.join();
+}
+
+#endif
@@ -6,6 +6,8 @@
 #include <limits.h> // INT_MAX
 #include <float.h> //DBL_MAX
 #include <time.h> 
+#include "common/itemStore.h" // colunas contíguas [profit], [weight] + ordem por razão
+#include "common/instanceReader.h" // leitura via mmap
 //n_400_c_1000000_g_14_f_0.1_eps_0_s_100
 //n - number of itens
 //c - capacity
@@ -18,7 +20,7 @@ int calculateSolProfit(bool *sol);//calculate the profit of a given solution - i
 void tweak(bool* sol);
 void readFile(const char* fileName);
 
-int **itens, size=-1, maxWeight=-1; //[profit, weight]
+ItemStore itens; int size=-1, maxWeight=-1; //itens.profit[i], itens.weight[i]
 
 int main(const int argc, const char **inputFile){
 	char fileName[100]="";
@@ -68,8 +70,8 @@ int calculateSolProfit(bool *sol){//calculate the profit of a given solution - i
 	int weight=0;
 	for(int i=0; i<size; i++){
 		if(sol[i]){
-			profit+=itens[i][0];//[profit, weight]
-			weight+=itens[i][1];
+			profit+=itens.profit[i];
+			weight+=itens.weight[i];
 		}
 	}
 	if(weight>maxWeight)
@@ -78,41 +80,17 @@ int calculateSolProfit(bool *sol){//calculate the profit of a given solution - i
 }
 
 void readFile(const char* fileName){
-	char s[500];
-	FILE *stream = fopen(fileName, "r"); //read file (read-only permission)
-	if( stream == NULL ){ // if the file was not read, error
+	//the file is memory-mapped and parsed by common/instanceReader.h (no fgets/strtok/atoi)
+	long long capacity=-1;
+	LoadStatus status = loadInstance(fileName, itens, capacity);
+	if(status == LOAD_OPEN_FAILED){ // if the file was not read, error
 		fprintf(stderr,"\nFail to Open File!!\n");
 		exit(1);
 	}
-	int line=-1;
-	while(fgets(s,500,stream)){ //read every line (not larger than 500 chars) of the input
-		if(strlen(s)-1>0) //remove the last break line of the line
-			s[strlen(s)-1]='\0';
-		if(('\r'==s[strlen(s)-1]))//in some files there is a carriage return at the end, don't know why. This command removes it
-			s[strlen(s)-1]=0;
-		
-		char* value1 = strtok(s," "); //creating sub-strings separated by space
-		char* value2 = strtok(NULL," ");
-		char* value3 = strtok(NULL," ");
-		line++;
-		
-		if(line==0){//it is the number o items
-			size=atoi(value1);
-			itens=(int**)malloc(size * sizeof(int*));			
-			for (int i=0;i<size;i++)
-				itens[i] = (int*)malloc(2 * sizeof(int));//two collumns [profit, weight]
-		}
-		
-		if(line>0 && line<size+1){//descriptions of the itens [id, profit, weight]
-			int id=atoi(value1);
-			if(id!=line-1){
-				fprintf(stderr,"\nERROR! Invalid knapsack file, aborting!!\n");
-				exit(1);
-			}
-			itens[id][0]=atoi(value2);
-			itens[id][1]=atoi(value3);
-		}
-		if(line==size+1)
-			maxWeight=atoi(value1);
+	if(status != LOAD_OK){ //invalid id, truncated file or out of memory
+		fprintf(stderr,"\nERROR! Invalid knapsack file, aborting!!\n");
+		exit(1);
 	}
+	size=itens.n;
+	maxWeight=(int)capacity;
 }
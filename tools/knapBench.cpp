@@ -0,0 +1,381 @@
+// Benchmark dos solvers em nanossegundos, com aquecimento e repetições.
+//
+//  - micro: leitura do texto, gulosa, avaliação completa, avaliação de um movimento,
+//    teste de aceitação (em bloco, exato e exp() de referência) e sorteio do RNG,
+//    na primeira instância amostrada de cada estrato;
+//  - macro: leitura + gulosa + SA do Adrias (as mesmas rotinas do solver, com as
+//    opções padrão) sobre uma amostra estratificada das instâncias, agrupada pelos
+//    parâmetros n/c/g/f/eps/s do nome do diretório, com resumo por estrato.
+//
+// Uso:
+//   knapsack_bench [problemInstances | manifesto] [opções]
+//     --strata n,c        parâmetros que definem os estratos (padrão n,c; "all" = os seis)
+//     --per-stratum K     instâncias sorteadas por estrato (padrão 2; 0 = todas)
+//     --reps R            repetições medidas (padrão 5)
+//     --warmup W          repetições descartadas antes das medidas (padrão 1)
+//     --seed S            semente da amostra e do SA (padrão 42)
+//     --micro | --macro   só uma das partes (padrão: as duas)
+//     --json arq.json     resultados em JSON
+//     --csv arq.csv       resultados em CSV (sem --json/--csv: CSV na saída padrão)
+//
+// CSV: secao,nome,estrato,instancia,n,reps,ops,mediana_ns,min_ns,media_ns,max_ns,lucro_guloso,lucro_sa
+// (micro: tempos por operação; macro: uma linha por etapa parse/greedy/sa/total;
+// estrato: média das medianas das instâncias do estrato).
+//
+// Compilar: g++ -O3 -march=native -std=c++17 -pthread tools/knapBench.cpp -o knapsack_bench
+// O Adrias é incluído sem o main (KNAPSA_NO_MAIN): o macro mede o código do solver.
+
+#define KNAPSA_NO_MAIN
+#include "../Adrias/Adrias_knapSA.cpp"
+#include <map>
+
+static volatile long long sink; // impede que o compilador descarte o trabalho medido
+
+static long long nowNs(){
+	return static_cast<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+struct Stats { double median = 0, min = 0, mean = 0, max = 0; };
+
+static Stats summarize(std::vector<double> v){
+	Stats st;
+	if(v.empty()) return st;
+	std::sort(v.begin(), v.end());
+	size_t m = v.size();
+	st.median = (m % 2) ? v[m/2] : 0.5 * (v[m/2 - 1] + v[m/2]);
+	st.min = v.front();
+	st.max = v.back();
+	double sum = 0;
+	for(double x : v) sum += x;
+	st.mean = sum / static_cast<double>(m);
+	return st;
+}
+
+struct BenchOptions {
+	const char *source = "problemInstances";
+	std::vector<std::string> strata{"n", "c"};
+	int perStratum = 2;
+	int reps = 5, warmup = 1;
+	unsigned int seed = 42;
+	bool micro = true, macro = true;
+	const char *jsonPath = nullptr, *csvPath = nullptr;
+};
+
+// Uma linha de resultado (micro, macro ou estrato)
+struct BenchRow {
+	std::string section, name, stratum, instance;
+	int n = 0, reps = 0;
+	long long ops = 1;
+	Stats st;
+	long long greedyProfit = -1, saProfit = -1;
+};
+
+// warmup + reps execuções de body(), que faz ops operações; amostras em ns por operação
+template<class F>
+static Stats measure(const BenchOptions &bo, long long ops, F body){
+	for(int w=0; w<bo.warmup; ++w) body();
+	std::vector<double> samples;
+	samples.reserve(bo.reps);
+	for(int r=0; r<bo.reps; ++r){
+		long long t0 = nowNs();
+		body();
+		long long t1 = nowNs();
+		samples.push_back(static_cast<double>(t1 - t0) / static_cast<double>(ops));
+	}
+	return summarize(samples);
+}
+
+// Chave do estrato: "n=400,c=1000000" com os parâmetros escolhidos
+static std::string stratumKey(const std::string &path, const std::vector<std::string> &dims){
+	InstanceParams p;
+	if(!parseInstanceParams(instanceNameFromPath(path.c_str()).c_str(), p)) return "desconhecido";
+	std::string key;
+	char buf[64];
+	for(const std::string &d : dims){
+		if(d == "n") snprintf(buf, sizeof(buf), "n=%d", p.n);
+		else if(d == "c") snprintf(buf, sizeof(buf), "c=%lld", p.c);
+		else if(d == "g") snprintf(buf, sizeof(buf), "g=%d", p.g);
+		else if(d == "f") snprintf(buf, sizeof(buf), "f=%g", p.f);
+		else if(d == "eps") snprintf(buf, sizeof(buf), "eps=%g", p.eps);
+		else snprintf(buf, sizeof(buf), "s=%d", p.s);
+		if(!key.empty()) key += ",";
+		key += buf;
+	}
+	return key;
+}
+
+static void microBench(const BenchOptions &bo, const std::string &path, const std::string &stratum, std::vector<BenchRow> &rows){
+	const int MOVES = 1 << 16;
+	auto add = [&](const char *name, long long ops, const Stats &st){
+		BenchRow r;
+		r.section = "micro"; r.name = name; r.stratum = stratum; r.instance = path;
+		r.n = size; r.reps = bo.reps; r.ops = ops; r.st = st;
+		rows.push_back(r);
+	};
+
+	// Leitura do texto (cache de páginas quente depois do aquecimento)
+	static ItemStore scratch;
+	long long scratchCap;
+	add("parse", 1, measure(bo, 1, [&](){
+		if(loadInstance(path.c_str(), scratch, scratchCap) == LOAD_OK) sink += scratch.n;
+	}));
+
+	Solution sol(size);
+	add("greedy", 1, measure(bo, 1, [&](){
+		sol.clear();
+		sink += greedySolution(sol);
+	}));
+
+	// Ordenação completa por razão (o que a gulosa deixou de fazer; limites e exatos usam)
+	add("ratio_order", 1, measure(bo, 1, [&](){
+		itens.finalize();
+		sink += itens.ratioOrder()[0];
+	}));
+
+	const int EVALS = 64;
+	add("eval_full", EVALS, measure(bo, EVALS, [&](){
+		long long p = 0, w = 0;
+		for(int k=0; k<EVALS; ++k){ solutionTotals(itens, sol, p, w); sink += p; }
+	}));
+
+	// Avaliação incremental de um movimento (sorteio + delta), como no laço do SA
+	double penaltyCoef = penaltyCoefficient(10.0L);
+	long long profit = 0, weight = 0;
+	solutionTotals(itens, sol, profit, weight);
+	Rng rng(bo.seed);
+	std::vector<double> deltas(MOVES);
+	add("move_eval", MOVES, measure(bo, MOVES, [&](){
+		for(int k=0; k<MOVES; ++k){
+			int f1=-1, f2=-1; bool two=false;
+			tweak(rng, f1, f2, two);
+			long long np = profit, nw = weight;
+			if(!sol.get(f1)){ np += itens.profit[f1]; nw += itens.weight[f1]; }
+			else{ np -= itens.profit[f1]; nw -= itens.weight[f1]; }
+			if(two){
+				if(!sol.get(f2)){ np += itens.profit[f2]; nw += itens.weight[f2]; }
+				else{ np -= itens.profit[f2]; nw -= itens.weight[f2]; }
+			}
+			long long excess = (nw > maxWeight) ? (nw - maxWeight) : 0;
+			deltas[k] = static_cast<double>(np - profit) - penaltyCoef * static_cast<double>(excess);
+		}
+	}));
+
+	// Teste de Metropolis sobre as pioras amostradas, na temperatura de 50% de aceitação
+	std::vector<double> worsening;
+	for(double d : deltas) if(d < 0.0) worsening.push_back(-d);
+	if(worsening.empty()) worsening.push_back(1.0);
+	double T = temperatureForAcceptance(worsening, 0.5);
+	int W = static_cast<int>(worsening.size());
+	MetropolisThresholds metropolis;
+	add("accept_batch", MOVES, measure(bo, MOVES, [&](){
+		long long acc = 0;
+		for(int k=0; k<MOVES; ++k) acc += metropolis.accept(rng, -worsening[k % W], T);
+		sink += acc;
+	}));
+	metropolis.exact = true;
+	add("accept_exact", MOVES, measure(bo, MOVES, [&](){
+		long long acc = 0;
+		for(int k=0; k<MOVES; ++k) acc += metropolis.accept(rng, -worsening[k % W], T);
+		sink += acc;
+	}));
+	add("accept_exp", MOVES, measure(bo, MOVES, [&](){ // u < exp(delta/T), a forma original
+		long long acc = 0;
+		for(int k=0; k<MOVES; ++k) acc += rng.uniform() < std::exp(-worsening[k % W] / T);
+		sink += acc;
+	}));
+	add("rng_below", MOVES, measure(bo, MOVES, [&](){
+		long long acc = 0;
+		for(int k=0; k<MOVES; ++k) acc += rng.below(static_cast<uint32_t>(size));
+		sink += acc;
+	}));
+}
+
+static void macroBench(const BenchOptions &bo, const std::string &path, const std::string &stratum, std::vector<BenchRow> &rows){
+	RunOptions opts;
+	opts.seed = bo.seed;
+	std::vector<double> parseNs, greedyNs, saNs, totalNs;
+	long long greedyProfit = -1, saProfit = -1;
+	bool ok = true;
+	for(int r=0; r<bo.warmup + bo.reps && ok; ++r){
+		long long t0 = nowNs();
+		ok = readFile(path.c_str());
+		if(!ok) break;
+		long long t1 = nowNs();
+		Solution &sol = work.greedySol;
+		sol.resize(size);
+		greedyProfit = greedySolution(sol);
+		long long t2 = nowNs();
+		annealFromStart(path.c_str(), prepareStart(sol, opts), penaltyCoefficient(opts.penaltyFactor), opts, -1, work.saSol, saProfit);
+		long long t3 = nowNs();
+		if(r < bo.warmup) continue;
+		parseNs.push_back(static_cast<double>(t1 - t0));
+		greedyNs.push_back(static_cast<double>(t2 - t1));
+		saNs.push_back(static_cast<double>(t3 - t2));
+		totalNs.push_back(static_cast<double>(t3 - t0));
+	}
+	if(!ok){
+		fprintf(stderr,"skipping %s\n", path.c_str());
+		return;
+	}
+	const char *names[4] = {"parse", "greedy", "sa", "total"};
+	std::vector<double> *samples[4] = {&parseNs, &greedyNs, &saNs, &totalNs};
+	for(int k=0; k<4; ++k){
+		BenchRow row;
+		row.section = "macro"; row.name = names[k]; row.stratum = stratum; row.instance = path;
+		row.n = size; row.reps = bo.reps; row.st = summarize(*samples[k]);
+		row.greedyProfit = greedyProfit; row.saProfit = saProfit;
+		rows.push_back(row);
+	}
+}
+
+// Resumo por estrato: média das medianas (e dos lucros) das instâncias do estrato
+static void stratumSummary(std::vector<BenchRow> &rows){
+	std::map<std::pair<std::string, std::string>, std::vector<const BenchRow*>> groups;
+	for(const BenchRow &r : rows)
+		if(r.section == "macro") groups[{r.stratum, r.name}].push_back(&r);
+	std::vector<BenchRow> out;
+	for(const auto &g : groups){
+		BenchRow s;
+		s.section = "stratum"; s.stratum = g.first.first; s.name = g.first.second;
+		s.reps = static_cast<int>(g.second.size()); // instâncias no estrato
+		std::vector<double> med;
+		double gp = 0, sp = 0;
+		for(const BenchRow *r : g.second){
+			med.push_back(r->st.median);
+			s.n = std::max(s.n, r->n);
+			gp += static_cast<double>(r->greedyProfit);
+			sp += static_cast<double>(r->saProfit);
+		}
+		s.st = summarize(med);
+		s.st.median = s.st.mean; // linha de estrato: média das medianas
+		s.greedyProfit = static_cast<long long>(gp / med.size());
+		s.saProfit = static_cast<long long>(sp / med.size());
+		out.push_back(s);
+	}
+	rows.insert(rows.end(), out.begin(), out.end());
+}
+
+static void writeCsv(FILE *out, const std::vector<BenchRow> &rows){
+	fprintf(out, "secao,nome,estrato,instancia,n,reps,ops,mediana_ns,min_ns,media_ns,max_ns,lucro_guloso,lucro_sa\n");
+	for(const BenchRow &r : rows)
+		fprintf(out, "%s,%s,\"%s\",%s,%d,%d,%lld,%.1f,%.1f,%.1f,%.1f,%lld,%lld\n", r.section.c_str(), r.name.c_str(), r.stratum.c_str(),
+		        r.instance.c_str(), r.n, r.reps, r.ops, r.st.median, r.st.min, r.st.mean, r.st.max, r.greedyProfit, r.saProfit);
+}
+
+static void jsonString(FILE *out, const std::string &s){
+	fputc('"', out);
+	for(char ch : s){
+		if(ch == '"' || ch == '\\') fputc('\\', out);
+		fputc(ch, out);
+	}
+	fputc('"', out);
+}
+
+static void writeJson(FILE *out, const BenchOptions &bo, const std::vector<BenchRow> &rows){
+	fprintf(out, "{\n  \"compiler\": \"%s\",\n  \"reps\": %d,\n  \"warmup\": %d,\n  \"seed\": %u,\n  \"strata\": ",
+	        __VERSION__, bo.reps, bo.warmup, bo.seed);
+	std::string dims;
+	for(const std::string &d : bo.strata) dims += (dims.empty() ? "" : ",") + d;
+	jsonString(out, dims);
+	fprintf(out, ",\n  \"results\": [");
+	for(size_t i=0; i<rows.size(); ++i){
+		const BenchRow &r = rows[i];
+		fprintf(out, "%s\n    {\"section\": ", i ? "," : "");
+		jsonString(out, r.section);
+		fprintf(out, ", \"name\": "); jsonString(out, r.name);
+		fprintf(out, ", \"stratum\": "); jsonString(out, r.stratum);
+		fprintf(out, ", \"instance\": "); jsonString(out, r.instance);
+		fprintf(out, ", \"n\": %d, \"reps\": %d, \"ops\": %lld, \"median_ns\": %.1f, \"min_ns\": %.1f, \"mean_ns\": %.1f, \"max_ns\": %.1f, \"greedy_profit\": %lld, \"sa_profit\": %lld}",
+		        r.n, r.reps, r.ops, r.st.median, r.st.min, r.st.mean, r.st.max, r.greedyProfit, r.saProfit);
+	}
+	fprintf(out, "\n  ]\n}\n");
+}
+
+static FILE *openOutput(const char *path){
+	FILE *f = fopen(path, "w");
+	if(f == NULL){
+		fprintf(stderr,"\nFail to Open File!! (%s)\n", path);
+		exit(1);
+	}
+	return f;
+}
+
+int main(int argc, char **argv){
+	BenchOptions bo;
+	for(int ai=1; ai<argc; ++ai){
+		const char *arg = argv[ai];
+		const char *val = (ai+1 < argc) ? argv[ai+1] : "";
+		if(strcmp(arg, "--strata") == 0){
+			bo.strata.clear();
+			std::string list = strcmp(val, "all") == 0 ? "n,c,g,f,eps,s" : val;
+			for(size_t pos=0; pos<=list.size(); ){
+				size_t comma = list.find(',', pos);
+				if(comma == std::string::npos) comma = list.size();
+				std::string d = list.substr(pos, comma - pos);
+				if(d != "n" && d != "c" && d != "g" && d != "f" && d != "eps" && d != "s"){
+					fprintf(stderr,"unknown stratum parameter: %s (use n,c,g,f,eps,s)\n", d.c_str());
+					return 1;
+				}
+				bo.strata.push_back(d);
+				pos = comma + 1;
+			}
+			++ai;
+		}else if(strcmp(arg, "--per-stratum") == 0){ bo.perStratum = atoi(val); ++ai; }
+		else if(strcmp(arg, "--reps") == 0){ bo.reps = std::max(1, atoi(val)); ++ai; }
+		else if(strcmp(arg, "--warmup") == 0){ bo.warmup = std::max(0, atoi(val)); ++ai; }
+		else if(strcmp(arg, "--seed") == 0){ bo.seed = static_cast<unsigned int>(strtoul(val, nullptr, 10)); ++ai; }
+		else if(strcmp(arg, "--micro") == 0){ bo.micro = true; bo.macro = false; }
+		else if(strcmp(arg, "--macro") == 0){ bo.macro = true; bo.micro = false; }
+		else if(strcmp(arg, "--json") == 0){ bo.jsonPath = val; ++ai; }
+		else if(strcmp(arg, "--csv") == 0){ bo.csvPath = val; ++ai; }
+		else if(arg[0] == '-' && arg[1] == '-'){
+			fprintf(stderr,"use: knapsack_bench [problemInstances | manifest] [--strata n,c] [--per-stratum K] [--reps R] [--warmup W]\n"
+			               "                      [--seed S] [--micro | --macro] [--json file.json] [--csv file.csv]\n");
+			return 1;
+		}else bo.source = arg;
+	}
+
+	std::vector<std::string> paths;
+	std::error_code ec;
+	if(std::filesystem::is_directory(bo.source, ec)) collectInstances(bo.source, paths);
+	else{
+		FILE *manifest = fopen(bo.source, "r");
+		if(manifest == NULL){
+			fprintf(stderr,"\nFail to Open File!! (%s)\n", bo.source);
+			return 1;
+		}
+		readManifest(manifest, paths);
+		fclose(manifest);
+	}
+
+	// Amostra estratificada: K instâncias sorteadas (com a semente) de cada estrato
+	std::map<std::string, std::vector<std::string>> strata;
+	for(const std::string &p : paths) strata[stratumKey(p, bo.strata)].push_back(p);
+	Rng rng(streamSeed(bo.seed, 0xBE4C));
+	std::vector<BenchRow> rows;
+	int sampled = 0;
+	for(auto &st : strata){
+		std::vector<std::string> &v = st.second;
+		for(int i=static_cast<int>(v.size())-1; i>0; --i) std::swap(v[i], v[rng.below(static_cast<uint32_t>(i + 1))]);
+		if(bo.perStratum > 0 && static_cast<int>(v.size()) > bo.perStratum) v.resize(bo.perStratum);
+		for(size_t k=0; k<v.size(); ++k){
+			if(k == 0 && bo.micro){
+				if(!readFile(v[k].c_str())){
+					fprintf(stderr,"skipping %s\n", v[k].c_str());
+					continue;
+				}
+				microBench(bo, v[k], st.first, rows);
+			}
+			if(bo.macro) macroBench(bo, v[k], st.first, rows);
+			++sampled;
+		}
+		fprintf(stderr,"%s: %zu instance(s)\n", st.first.c_str(), v.size());
+	}
+	if(bo.macro) stratumSummary(rows);
+	fprintf(stderr,"%d instance(s) in %zu strata\n", sampled, strata.size());
+
+	if(bo.csvPath){ FILE *f = openOutput(bo.csvPath); writeCsv(f, rows); fclose(f); }
+	if(bo.jsonPath){ FILE *f = openOutput(bo.jsonPath); writeJson(f, bo, rows); fclose(f); }
+	if(!bo.csvPath && !bo.jsonPath) writeCsv(stdout, rows);
+	return 0;
+}
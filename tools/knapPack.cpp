@@ -0,0 +1,176 @@
+// Conversor de instâncias para o formato binário de common/instanceReader.h
+//
+// Uso:
+//   knapPack <problemInstances> <saida.knpa>   empacota todos os test.in em um arquivo indexado
+//   knapPack --single <test.in> <saida.knpb>   converte uma instância avulsa
+//   knapPack --list <arquivo.knpa>             lista as instâncias (nome,n,capacidade)
+//
+// Compilar: g++ -O2 -std=c++17 tools/knapPack.cpp -o knapPack
+// Os solvers aceitam o resultado no lugar do texto: o .knpb direto, o .knpa
+// inteiro (Adrias) ou uma entrada "<arquivo.knpa>:<nome>".
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "../common/itemStore.h"
+#include "../common/instanceReader.h"
+
+// Escreve bytes zerados até o próximo múltiplo de 64
+static bool padTo64(FILE *out, uint64_t &pos){
+	static const char zeros[64] = {0};
+	size_t pad = static_cast<size_t>((64 - (pos & 63)) & 63);
+	pos += pad;
+	return pad == 0 || fwrite(zeros, 1, pad, out) == pad;
+}
+
+// Escreve uma instância .knpb (cabeçalho + colunas alinhadas) a partir de pos; devolve os bytes escritos
+static uint64_t writeBinaryInstance(FILE *out, uint64_t &pos, const ItemStore &store, long long capacity, const InstanceParams &params, bool hasParams){
+	BinaryInstanceHeader h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, BINARY_INSTANCE_MAGIC, 4);
+	h.version = BINARY_INSTANCE_VERSION;
+	h.n = store.n;
+	h.capacity = capacity;
+	if(hasParams){
+		h.flags |= BINARY_HAS_PARAMS;
+		h.paramN = params.n; h.paramC = params.c; h.paramG = params.g;
+		h.paramF = params.f; h.paramEps = params.eps; h.paramS = params.s;
+	}
+	uint64_t start = pos;
+	bool ok = fwrite(&h, sizeof(h), 1, out) == 1;
+	pos += sizeof(h);
+	ok = ok && fwrite(store.profit, sizeof(int64_t), store.n, out) == static_cast<size_t>(store.n);
+	pos += sizeof(int64_t) * store.n;
+	ok = ok && padTo64(out, pos);
+	ok = ok && fwrite(store.weight, sizeof(int64_t), store.n, out) == static_cast<size_t>(store.n);
+	pos += sizeof(int64_t) * store.n;
+	ok = ok && padTo64(out, pos);
+	if(!ok){
+		fprintf(stderr,"\nFail to write output!!\n");
+		exit(1);
+	}
+	return pos - start;
+}
+
+static bool loadText(const char *fileName, ItemStore &store, long long &capacity){
+	LoadDiag diag;
+	LoadStatus status = loadInstance(fileName, store, capacity, &diag);
+	if(status == LOAD_OK) return true;
+	if(status == LOAD_INVALID_ID)
+		fprintf(stderr,"skipping %s (read id=%lld expected=%d)\n", fileName, diag.foundId, diag.expectedId);
+	else
+		fprintf(stderr,"skipping %s (status %d)\n", fileName, static_cast<int>(status));
+	return false;
+}
+
+static int packSingle(const char *input, const char *output){
+	ItemStore store;
+	long long capacity;
+	if(!loadText(input, store, capacity)) return 1;
+	InstanceParams params;
+	bool hasParams = parseInstanceParams(instanceNameFromPath(input).c_str(), params);
+	FILE *out = fopen(output, "wb");
+	if(out == NULL){
+		fprintf(stderr,"\nFail to Open File!! (%s)\n", output);
+		return 1;
+	}
+	uint64_t pos = 0;
+	writeBinaryInstance(out, pos, store, capacity, params, hasParams);
+	fclose(out);
+	return 0;
+}
+
+static int packTree(const char *dir, const char *output){
+	// Instâncias em ordem alfabética do nome do diretório (o índice usa busca binária)
+	std::vector<std::pair<std::string, std::string>> found; // (nome, caminho)
+	std::error_code ec;
+	for(std::filesystem::recursive_directory_iterator itDir(dir, ec), end; !ec && itDir != end; itDir.increment(ec)){
+		if(itDir->is_regular_file(ec) && itDir->path().filename() == "test.in")
+			found.emplace_back(itDir->path().parent_path().filename().string(), itDir->path().string());
+	}
+	if(ec){
+		fprintf(stderr,"\nFail to list directory!! (%s: %s)\n", dir, ec.message().c_str());
+		return 1;
+	}
+	std::sort(found.begin(), found.end());
+
+	FILE *out = fopen(output, "wb");
+	if(out == NULL){
+		fprintf(stderr,"\nFail to Open File!! (%s)\n", output);
+		return 1;
+	}
+	BinaryArchiveHeader header;
+	memset(&header, 0, sizeof(header));
+	fwrite(&header, sizeof(header), 1, out); // reescrito no final
+	uint64_t pos = sizeof(header);
+
+	std::vector<BinaryArchiveEntry> index;
+	ItemStore store; // reaproveitado entre instâncias
+	long long capacity;
+	int failures = 0;
+	for(size_t k=0; k<found.size(); ++k){
+		const std::string &name = found[k].first;
+		if(name.size() >= sizeof(BinaryArchiveEntry::name) || (k > 0 && name == found[k-1].first)){
+			fprintf(stderr,"skipping %s (name too long or duplicated)\n", found[k].second.c_str());
+			++failures;
+			continue;
+		}
+		if(!loadText(found[k].second.c_str(), store, capacity)){ ++failures; continue; }
+		InstanceParams params;
+		bool hasParams = parseInstanceParams(name.c_str(), params);
+		BinaryArchiveEntry e;
+		memset(&e, 0, sizeof(e));
+		e.offset = pos;
+		e.bytes = writeBinaryInstance(out, pos, store, capacity, params, hasParams);
+		memcpy(e.name, name.c_str(), name.size());
+		index.push_back(e);
+		header.totalItems += static_cast<uint64_t>(store.n);
+	}
+
+	memcpy(header.magic, BINARY_ARCHIVE_MAGIC, 4);
+	header.version = BINARY_ARCHIVE_VERSION;
+	header.count = static_cast<uint32_t>(index.size());
+	header.indexOffset = pos;
+	bool ok = index.empty() || fwrite(index.data(), sizeof(BinaryArchiveEntry), index.size(), out) == index.size();
+	ok = ok && fseek(out, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, out) == 1;
+	ok = (fclose(out) == 0) && ok;
+	if(!ok){
+		fprintf(stderr,"\nFail to write output!! (%s)\n", output);
+		return 1;
+	}
+	fprintf(stderr,"%u instances, %llu items packed into %s\n", header.count, (unsigned long long)header.totalItems, output);
+	return failures == 0 ? 0 : 2;
+}
+
+static int listArchive(const char *fileName){
+	InstanceArchive archive;
+	if(!archive.open(fileName)){
+		fprintf(stderr,"\nERROR! Invalid instance archive!! (%s)\n", fileName);
+		return 1;
+	}
+	ItemStore store;
+	long long capacity;
+	printf("instancia,n,capacidade\n");
+	for(int i=0; i<archive.count(); ++i){
+		if(archive.load(i, store, capacity) != LOAD_OK){
+			fprintf(stderr,"corrupted entry %s\n", archive.name(i));
+			return 2;
+		}
+		printf("%s,%d,%lld\n", archive.name(i), store.n, capacity);
+	}
+	return 0;
+}
+
+int main(int argc, char **argv){
+	if(argc == 4 && strcmp(argv[1], "--single") == 0) return packSingle(argv[2], argv[3]);
+	if(argc == 3 && strcmp(argv[1], "--list") == 0) return listArchive(argv[2]);
+	if(argc == 3 && argv[1][0] != '-') return packTree(argv[1], argv[2]);
+	fprintf(stderr,"use: knapPack <problemInstances dir> <out.knpa>\n"
+	               "     knapPack --single <test.in> <out.knpb>\n"
+	               "     knapPack --list <archive.knpa>\n\n");
+	return 1;
+}
@@ -0,0 +1,581 @@
+// Ajuste offline dos parâmetros do SA do Adrias por classe de instância (n x c), por
+// corrida (F-race), gerando o perfil que o solver carrega com --profile.
+//
+// Cada classe corre separadamente com as mesmas candidatas: a configuração padrão do
+// solver e --candidates configurações sorteadas nas faixas abaixo. A corrida avança em
+// blocos; um bloco é uma instância da classe com uma semente, resolvida por todas as
+// candidatas ainda vivas (mesma instância e semente: comparação pareada). A partir do
+// bloco --first-test, cada bloco termina com um teste entre as vivas (--test):
+//  - t (padrão): teste t pareado (com correção de Bonferroni) de cada uma contra a de
+//    menor custo médio; saem as significativamente piores. Compara médias, que é o que
+//    o custo mede.
+//  - friedman: o da F-race original, sobre os postos dos custos em cada bloco; havendo
+//    diferença, saem as piores que a melhor (menor soma de postos) pela comparação
+//    múltipla de Conover. Ignora o tamanho das diferenças: uma candidata 1 ms mais rápida
+//    quase sempre e muito pior às vezes ganha da padrão.
+// A corrida da classe termina quando sobra uma candidata ou quando o próximo bloco
+// passaria do orçamento de avaliações (--budget); as instâncias da classe são reusadas
+// com novas sementes se acabarem antes. A vencedora (menor custo médio com t, menor soma
+// de postos com friedman, entre as vivas) vai para o perfil.
+//
+// Custo de uma avaliação: gap até o ótimo em % (ótimo de --optima; sem ele, o melhor
+// lucro do bloco) + --ms-weight * tempo_total_ms do solver, ou seja, quanto gap vale um
+// milissegundo. Com --time-limit-ms o SA roda com orçamento fixo (o perfil vale para
+// execuções com o mesmo orçamento) e o peso do tempo pode ser zero.
+//
+// Cada avaliação é um processo do solver (--solver) com os parâmetros na linha de
+// comando: o Adrias guarda a instância em globais, então avaliações simultâneas precisam
+// de processos separados. Cada rodada junta o próximo bloco de todas as classes que ainda
+// correm e distribui as avaliações entre --threads threads (maiores instâncias primeiro).
+//
+// Faixas sorteadas: penalidade 1..100 (log), aceitação inicial 0.05..0.9, aceitação
+// final 1e-5..1e-2 (log), fator de patamar 0.1..4 (log), alpha 0.9..0.999 (1 - alpha em
+// log), início greedy ou ls.
+//
+// Uso:
+//   knapsack_tune [problemInstances | manifesto] [opções]
+//     --solver ./knapSA     executável do Adrias usado nas avaliações (padrão ./knapSA)
+//     --optima optima.csv   ótimos conhecidos
+//     --out perfil.csv      perfil gerado (padrão sa_profile.csv)
+//     --log arq.csv         todas as avaliações (classe,bloco,instancia,semente,candidata,lucro,tempo_ms,custo)
+//     --candidates N        candidatas sorteadas além da padrão (padrão 24)
+//     --budget E            avaliações por classe (padrão 600)
+//     --first-test B        blocos antes do primeiro teste (padrão 5)
+//     --test t|friedman     teste de eliminação (padrão t)
+//     --confidence C        nível de confiança dos testes (padrão 0.95)
+//     --time-limit-ms T     orçamento do SA em cada avaliação (padrão 0 = resfriamento completo)
+//     --ms-weight W         pontos percentuais de gap equivalentes a 1 ms (padrão 0.001)
+//     --per-class K         instâncias sorteadas por classe (padrão 0 = todas)
+//     --classes a,b         só essas classes (ex.: n_400_c_1000000)
+//     --threads N           avaliações simultâneas (padrão 0 = todos os núcleos)
+//     --seed S              semente dos sorteios e das avaliações (padrão 1)
+//
+// Compilar: g++ -O3 -march=native -std=c++17 -pthread tools/knapTune.cpp -o knapsack_tune
+// O Adrias é incluído sem o main (KNAPSA_NO_MAIN) para os valores padrão das opções e a
+// leitura da lista de instâncias.
+
+#define KNAPSA_NO_MAIN
+#include "../Adrias/Adrias_knapSA.cpp"
+#include <map>
+#if defined(_WIN32)
+#define popen _popen
+#define pclose _pclose
+#endif
+
+struct TuneOptions {
+	const char *source = "problemInstances";
+	const char *solver = "./knapSA";
+	const char *optimaPath = nullptr;
+	const char *outPath = "sa_profile.csv";
+	const char *logPath = nullptr;
+	int candidates = 24;
+	long long budget = 600;
+	int firstTest = 5;
+	bool friedman = false;
+	double confidence = 0.95;
+	long long timeLimitMs = 0;
+	double msWeight = 0.001;
+	int perClass = 0;
+	std::vector<std::string> classes;
+	int threads = 0;
+	unsigned int seed = 1;
+};
+
+// --- Distribuições para os testes (funções incompletas como no Numerical Recipes)
+
+// Gama incompleta regularizada P(a, x)
+static double gammaP(double a, double x){
+	if(x <= 0.0) return 0.0;
+	double front = std::exp(-x + a * std::log(x) - std::lgamma(a));
+	if(x < a + 1.0){ // série
+		double term = 1.0 / a, sum = term;
+		for(int n=1; n<1000 && std::fabs(term) > std::fabs(sum) * 1e-15; ++n){
+			term *= x / (a + n);
+			sum += term;
+		}
+		return sum * front;
+	}
+	// fração contínua de Q(a, x) (Lentz)
+	const double TINY = 1e-300;
+	double b = x + 1.0 - a, c = 1.0 / TINY, d = 1.0 / b, h = d;
+	for(int i=1; i<1000; ++i){
+		double an = -i * (i - a);
+		b += 2.0;
+		d = an * d + b; if(std::fabs(d) < TINY) d = TINY;
+		c = b + an / c; if(std::fabs(c) < TINY) c = TINY;
+		d = 1.0 / d;
+		double del = d * c;
+		h *= del;
+		if(std::fabs(del - 1.0) < 1e-15) break;
+	}
+	return 1.0 - front * h;
+}
+
+// Fração contínua da beta incompleta (Lentz)
+static double betaFraction(double a, double b, double x){
+	const double TINY = 1e-300;
+	double qab = a + b, qap = a + 1.0, qam = a - 1.0;
+	double c = 1.0, d = 1.0 - qab * x / qap;
+	if(std::fabs(d) < TINY) d = TINY;
+	d = 1.0 / d;
+	double h = d;
+	for(int m=1; m<1000; ++m){
+		int m2 = 2 * m;
+		double aa = m * (b - m) * x / ((qam + m2) * (a + m2));
+		d = 1.0 + aa * d; if(std::fabs(d) < TINY) d = TINY;
+		c = 1.0 + aa / c; if(std::fabs(c) < TINY) c = TINY;
+		d = 1.0 / d;
+		h *= d * c;
+		aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2));
+		d = 1.0 + aa * d; if(std::fabs(d) < TINY) d = TINY;
+		c = 1.0 + aa / c; if(std::fabs(c) < TINY) c = TINY;
+		d = 1.0 / d;
+		double del = d * c;
+		h *= del;
+		if(std::fabs(del - 1.0) < 1e-15) break;
+	}
+	return h;
+}
+
+// Beta incompleta regularizada I_x(a, b)
+static double betaI(double a, double b, double x){
+	if(x <= 0.0) return 0.0;
+	if(x >= 1.0) return 1.0;
+	double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log(1.0 - x));
+	if(x < (a + 1.0) / (a + b + 2.0)) return front * betaFraction(a, b, x) / a;
+	return 1.0 - front * betaFraction(b, a, 1.0 - x) / b;
+}
+
+// Quantil p de uma distribuição contínua em [0, inf) pela bisseção da CDF
+template<class Cdf>
+static double quantile(Cdf cdf, double p, double hi){
+	double lo = 0.0;
+	while(cdf(hi) < p) hi *= 2.0;
+	for(int k=0; k<200; ++k){
+		double mid = 0.5 * (lo + hi);
+		if(cdf(mid) < p) lo = mid; else hi = mid;
+	}
+	return 0.5 * (lo + hi);
+}
+
+static double chiSquareQuantile(double p, double df){
+	return quantile([df](double x){ return gammaP(0.5 * df, 0.5 * x); }, p, df + 10.0);
+}
+
+// Quantil p (>= 0.5) da t de Student
+static double studentQuantile(double p, double df){
+	return quantile([df](double t){ return 1.0 - 0.5 * betaI(0.5 * df, 0.5, df / (df + t * t)); }, p, 10.0);
+}
+
+// --- Teste de Friedman e comparação múltipla de Conover (F-race)
+
+// Postos dos custos de um bloco (1 = menor custo; empates recebem a média dos postos)
+static void rankBlock(const std::vector<double> &costs, std::vector<double> &ranks){
+	int k = static_cast<int>(costs.size());
+	std::vector<int> idx(k);
+	for(int j=0; j<k; ++j) idx[j] = j;
+	std::sort(idx.begin(), idx.end(), [&](int a, int b){ return costs[a] < costs[b]; });
+	ranks.assign(k, 0.0);
+	for(int s=0; s<k; ){
+		int e = s;
+		while(e + 1 < k && costs[idx[e + 1]] == costs[idx[s]]) ++e;
+		double r = 0.5 * (s + e) + 1.0;
+		for(int t=s; t<=e; ++t) ranks[idx[t]] = r;
+		s = e + 1;
+	}
+}
+
+// cost[j][b]: custo da candidata j (entre as vivas) no bloco b. rankSums recebe a soma
+// dos postos de cada candidata; devolve a soma dos quadrados dos postos.
+static double rankSumsOf(const std::vector<std::vector<double>> &cost, std::vector<double> &rankSums){
+	int k = static_cast<int>(cost.size());
+	int b = k ? static_cast<int>(cost[0].size()) : 0;
+	rankSums.assign(k, 0.0);
+	double squares = 0.0;
+	std::vector<double> block(k), ranks;
+	for(int t=0; t<b; ++t){
+		for(int j=0; j<k; ++j) block[j] = cost[j][t];
+		rankBlock(block, ranks);
+		for(int j=0; j<k; ++j){ rankSums[j] += ranks[j]; squares += ranks[j] * ranks[j]; }
+	}
+	return squares;
+}
+
+// Índices (em cost) das candidatas que continuam: todas se o teste de Friedman não
+// rejeitar a igualdade; senão as que não diferem da melhor (menor soma de postos) pela
+// comparação múltipla de Conover.
+static std::vector<int> friedmanSurvivors(const std::vector<std::vector<double>> &cost, double confidence){
+	std::vector<double> rankSums;
+	double A = rankSumsOf(cost, rankSums);
+	int k = static_cast<int>(cost.size());
+	int b = k ? static_cast<int>(cost[0].size()) : 0;
+	std::vector<int> all(k);
+	for(int j=0; j<k; ++j) all[j] = j;
+	if(k < 2 || b < 2) return all;
+	double C = b * k * (k + 1.0) * (k + 1.0) / 4.0;
+	if(A - C <= 1e-12) return all; // todos empatados em todos os blocos
+	double center = b * (k + 1.0) / 2.0, spread = 0.0;
+	for(double R : rankSums) spread += (R - center) * (R - center);
+	double T = (k - 1.0) * spread / (A - C);
+	if(T <= chiSquareQuantile(confidence, k - 1.0)) return all;
+	int best = 0;
+	for(int j=1; j<k; ++j) if(rankSums[j] < rankSums[best]) best = j;
+	double df = (b - 1.0) * (k - 1.0);
+	double agreement = std::max(0.0, 1.0 - T / (b * (k - 1.0)));
+	double limit = studentQuantile(1.0 - (1.0 - confidence) / 2.0, df) * std::sqrt(2.0 * b * agreement * (A - C) / df);
+	std::vector<int> keep;
+	for(int j=0; j<k; ++j)
+		if(rankSums[j] - rankSums[best] <= limit) keep.push_back(j);
+	return keep;
+}
+
+// Teste t pareado de cada candidata contra a de menor custo médio: continuam as que
+// não são significativamente piores. São k-1 comparações por bloco, então o nível de
+// cada uma tem a correção de Bonferroni (sem ela a padrão sai cedo por acaso).
+static std::vector<int> pairedSurvivors(const std::vector<std::vector<double>> &cost, double confidence){
+	int k = static_cast<int>(cost.size());
+	int b = k ? static_cast<int>(cost[0].size()) : 0;
+	std::vector<int> keep;
+	if(k < 2 || b < 2){
+		for(int j=0; j<k; ++j) keep.push_back(j);
+		return keep;
+	}
+	std::vector<double> mean(k, 0.0);
+	for(int j=0; j<k; ++j){
+		for(double c : cost[j]) mean[j] += c;
+		mean[j] /= b;
+	}
+	int best = static_cast<int>(std::min_element(mean.begin(), mean.end()) - mean.begin());
+	double limit = studentQuantile(1.0 - (1.0 - confidence) / (2.0 * (k - 1)), b - 1.0);
+	for(int j=0; j<k; ++j){
+		double d = mean[j] - mean[best], ss = 0.0;
+		for(int t=0; t<b; ++t){
+			double e = (cost[j][t] - cost[best][t]) - d;
+			ss += e * e;
+		}
+		double se = std::sqrt(ss / (b - 1.0) / b);
+		bool worse = (se > 0.0) ? (d / se > limit) : (d > 0.0); // se = 0: pior (ou igual) em todos os blocos pela mesma diferença
+		if(!worse) keep.push_back(j);
+	}
+	return keep;
+}
+
+// --- Candidatas e avaliações
+
+// Valor com 6 algarismos significativos: o mesmo que vai na linha de comando e no perfil
+static double sig6(double x){
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%.6g", x);
+	return strtod(buf, nullptr);
+}
+
+static double logUniform(Rng &rng, double lo, double hi){
+	return std::exp(std::log(lo) + rng.uniform() * (std::log(hi) - std::log(lo)));
+}
+
+// Candidata 0: os padrões do solver; as demais sorteadas nas faixas
+static std::vector<SAParams> sampleCandidates(const TuneOptions &to){
+	std::vector<SAParams> cand;
+	cand.push_back(paramsOf(RunOptions()));
+	Rng rng(streamSeed(to.seed, 0x7C4D));
+	for(int k=0; k<to.candidates; ++k){
+		SAParams p;
+		p.penaltyFactor = sig6(logUniform(rng, 1.0, 100.0));
+		p.initialAcceptance = sig6(0.05 + rng.uniform() * 0.85);
+		p.finalAcceptance = sig6(logUniform(rng, 1e-5, 1e-2));
+		p.levelFactor = sig6(logUniform(rng, 0.1, 4.0));
+		p.alpha = sig6(1.0 - logUniform(rng, 0.001, 0.1));
+		p.start = (rng.uniform() < 0.5) ? START_GREEDY : START_LOCAL;
+		cand.push_back(p);
+	}
+	return cand;
+}
+
+// Roda o solver numa instância com os parâmetros p; false se o processo falhar ou não
+// imprimir a linha da instância
+static bool evaluate(const TuneOptions &to, const SAParams &p, const std::string &path, unsigned int seed, long long &profit, double &ms){
+	char args[384];
+	snprintf(args, sizeof(args), " --seed %u --penalty %.6g --init-accept %.6g --final-accept %.6g --level-factor %.6g --alpha %.6g --start %s --time-limit-ms %lld",
+	         seed, p.penaltyFactor, p.initialAcceptance, p.finalAcceptance, p.levelFactor, p.alpha, PROFILE_START_NAMES[p.start], to.timeLimitMs);
+	std::string cmd = std::string("\"") + to.solver + "\" \"" + path + "\"" + args;
+#if defined(_WIN32)
+	cmd = "\"" + cmd + "\""; // cmd /c tira o primeiro par de aspas
+#endif
+	FILE *pipe = popen(cmd.c_str(), "r");
+	if(pipe == NULL) return false;
+	char line[1024];
+	bool parsed = false;
+	while(fgets(line, sizeof(line), pipe)){ // instancia,lucro_guloso,lucro_sa,tempo_guloso_ms,tempo_sa_ms,tempo_total_ms
+		if(parsed || strncmp(line, path.c_str(), path.size()) != 0 || line[path.size()] != ',') continue;
+		long long greedy, sa, greedyMs, saMs, totalMs;
+		if(sscanf(line + path.size() + 1, "%lld,%lld,%lld,%lld,%lld", &greedy, &sa, &greedyMs, &saMs, &totalMs) == 5){
+			profit = sa;
+			ms = static_cast<double>(totalMs);
+			parsed = true;
+		}
+	}
+	return pclose(pipe) == 0 && parsed;
+}
+
+// Corrida de uma classe
+struct Race {
+	std::string cls;
+	int n = 0;                               // itens (ordem das avaliações)
+	std::vector<std::string> instances;
+	std::vector<int> alive;                  // candidatas vivas
+	std::vector<std::vector<double>> cost;   // [candidata][bloco], enquanto viva
+	std::vector<int> eliminatedAt;           // bloco em que saiu (-1: viva)
+	int blocks = 0;
+	long long evaluations = 0;
+	bool done = false;
+};
+
+struct Evaluation {
+	int race, candidate;
+	long long profit = 0;
+	double ms = 0.0;
+	bool ok = false;
+};
+
+static const std::string &blockInstance(const Race &r, int block){ return r.instances[block % r.instances.size()]; }
+static unsigned int blockSeed(const TuneOptions &to, int block){ return to.seed + static_cast<unsigned int>(block); }
+
+// Fecha o bloco atual da corrida com as avaliações evals[first, last): custos, diário
+// (--log), teste e critério de parada
+static void closeBlock(const TuneOptions &to, const OptimaTable &known, Race &r, const std::vector<Evaluation> &evals,
+                       size_t first, size_t last, FILE *log){
+	const std::string &path = blockInstance(r, r.blocks);
+	long long reference = known.find(instanceNameFromPath(path));
+	if(reference <= 0){ // ótimo desconhecido: o melhor lucro do bloco
+		for(size_t e=first; e<last; ++e) if(evals[e].ok) reference = std::max(reference, evals[e].profit);
+	}
+	for(size_t e=first; e<last; ++e){
+		const Evaluation &ev = evals[e];
+		if(!ev.ok) fprintf(stderr,"evaluation failed: %s, candidate %d (counted as profit 0)\n", path.c_str(), ev.candidate);
+		double c = gapPercent(reference, ev.ok ? ev.profit : 0) + to.msWeight * ev.ms;
+		r.cost[ev.candidate].push_back(c);
+		if(log != NULL)
+			fprintf(log, "%s,%d,%s,%u,%d,%lld,%.0f,%.6f\n", r.cls.c_str(), r.blocks, path.c_str(), blockSeed(to, r.blocks),
+			        ev.candidate, ev.ok ? ev.profit : 0, ev.ms, c);
+	}
+	++r.blocks;
+	r.evaluations += static_cast<long long>(r.alive.size());
+	if(r.blocks >= to.firstTest && r.alive.size() > 1){
+		std::vector<std::vector<double>> m;
+		for(int j : r.alive) m.push_back(r.cost[j]);
+		std::vector<int> keep = to.friedman ? friedmanSurvivors(m, to.confidence) : pairedSurvivors(m, to.confidence);
+		if(keep.size() < r.alive.size()){
+			std::vector<int> next;
+			for(int j : keep) next.push_back(r.alive[j]);
+			for(int j : r.alive)
+				if(std::find(next.begin(), next.end(), j) == next.end()) r.eliminatedAt[j] = r.blocks;
+			r.alive.swap(next);
+		}
+	}
+	r.done = r.alive.size() <= 1 || r.evaluations + static_cast<long long>(r.alive.size()) > to.budget;
+}
+
+static double meanOf(const std::vector<double> &v, size_t count){
+	double s = 0.0;
+	for(size_t t=0; t<count; ++t) s += v[t];
+	return count ? s / static_cast<double>(count) : 0.0;
+}
+
+// Vencedora entre as vivas: menor custo médio (--test t) ou menor soma de postos
+// (friedman), desempatando pelo outro critério e depois pelo menor índice, o que
+// favorece a configuração padrão
+static int raceWinner(const TuneOptions &to, const Race &r){
+	std::vector<std::vector<double>> m;
+	for(int j : r.alive) m.push_back(r.cost[j]);
+	std::vector<double> rankSums;
+	rankSumsOf(m, rankSums);
+	int best = 0;
+	for(int j=1; j<static_cast<int>(r.alive.size()); ++j){
+		double mj = meanOf(m[j], r.blocks), mb = meanOf(m[best], r.blocks);
+		bool better = to.friedman ? (rankSums[j] < rankSums[best] || (rankSums[j] == rankSums[best] && mj < mb))
+		                          : (mj < mb || (mj == mb && rankSums[j] < rankSums[best]));
+		if(better) best = j;
+	}
+	return r.alive[best];
+}
+
+static void splitList(const char *list, std::vector<std::string> &out){
+	std::string s = list;
+	for(size_t pos=0; pos<=s.size(); ){
+		size_t comma = s.find(',', pos);
+		if(comma == std::string::npos) comma = s.size();
+		if(comma > pos) out.push_back(s.substr(pos, comma - pos));
+		pos = comma + 1;
+	}
+}
+
+static FILE *openOutput(const char *path){
+	FILE *f = fopen(path, "w");
+	if(f == NULL){
+		fprintf(stderr,"\nFail to Open File!! (%s)\n", path);
+		exit(1);
+	}
+	return f;
+}
+
+int main(int argc, char **argv){
+	TuneOptions to;
+	for(int ai=1; ai<argc; ++ai){
+		const char *arg = argv[ai];
+		const char *val = (ai+1 < argc) ? argv[ai+1] : "";
+		if(strcmp(arg, "--solver") == 0){ to.solver = val; ++ai; }
+		else if(strcmp(arg, "--optima") == 0){ to.optimaPath = val; ++ai; }
+		else if(strcmp(arg, "--out") == 0){ to.outPath = val; ++ai; }
+		else if(strcmp(arg, "--log") == 0){ to.logPath = val; ++ai; }
+		else if(strcmp(arg, "--candidates") == 0){ to.candidates = std::max(0, atoi(val)); ++ai; }
+		else if(strcmp(arg, "--budget") == 0){ to.budget = strtoll(val, nullptr, 10); ++ai; }
+		else if(strcmp(arg, "--first-test") == 0){ to.firstTest = std::max(2, atoi(val)); ++ai; }
+		else if(strcmp(arg, "--test") == 0){
+			if(strcmp(val, "t") == 0) to.friedman = false;
+			else if(strcmp(val, "friedman") == 0) to.friedman = true;
+			else{
+				fprintf(stderr,"unknown test: %s (use: t | friedman)\n", val);
+				return 1;
+			}
+			++ai;
+		}else if(strcmp(arg, "--confidence") == 0){ to.confidence = strtod(val, nullptr); ++ai; }
+		else if(strcmp(arg, "--time-limit-ms") == 0){ to.timeLimitMs = strtoll(val, nullptr, 10); ++ai; }
+		else if(strcmp(arg, "--ms-weight") == 0){ to.msWeight = strtod(val, nullptr); ++ai; }
+		else if(strcmp(arg, "--per-class") == 0){ to.perClass = atoi(val); ++ai; }
+		else if(strcmp(arg, "--classes") == 0){ splitList(val, to.classes); ++ai; }
+		else if(strcmp(arg, "--threads") == 0){ to.threads = atoi(val); ++ai; }
+		else if(strcmp(arg, "--seed") == 0){ to.seed = static_cast<unsigned int>(strtoul(val, nullptr, 10)); ++ai; }
+		else if(arg[0] == '-' && arg[1] == '-'){
+			fprintf(stderr,"use: knapsack_tune [problemInstances | manifest] [--solver ./knapSA] [--optima optima.csv] [--out profile.csv] [--log file.csv]\n"
+			               "                     [--candidates N] [--budget E] [--first-test B] [--test t|friedman] [--confidence C] [--time-limit-ms T] [--ms-weight W]\n"
+			               "                     [--per-class K] [--classes a,b] [--threads N] [--seed S]\n");
+			return 1;
+		}else to.source = arg;
+	}
+	if(to.confidence <= 0.0 || to.confidence >= 1.0){
+		fprintf(stderr,"--confidence must be in (0, 1)\n");
+		return 1;
+	}
+
+	OptimaTable known;
+	if(to.optimaPath != nullptr && !known.load(to.optimaPath)){
+		fprintf(stderr,"\nFail to Open File!! (%s)\n", to.optimaPath);
+		return 1;
+	}
+	std::vector<std::string> paths;
+	std::error_code ec;
+	if(std::filesystem::is_directory(to.source, ec)) collectInstances(to.source, paths);
+	else{
+		FILE *manifest = fopen(to.source, "r");
+		if(manifest == NULL){
+			fprintf(stderr,"\nFail to Open File!! (%s)\n", to.source);
+			return 1;
+		}
+		readManifest(manifest, paths);
+		fclose(manifest);
+	}
+
+	// Instâncias por classe, embaralhadas com a semente (--per-class: só as K primeiras)
+	std::map<std::string, std::vector<std::string>> byClass;
+	for(const std::string &p : paths){
+		std::string cls = instanceClass(instanceNameFromPath(p));
+		if(to.classes.empty() || std::find(to.classes.begin(), to.classes.end(), cls) != to.classes.end())
+			byClass[cls].push_back(p);
+	}
+	if(byClass.empty()){
+		fprintf(stderr,"no instances to tune\n");
+		return 1;
+	}
+	std::vector<SAParams> cand = sampleCandidates(to);
+	Rng rng(streamSeed(to.seed, 0x7A4E));
+	std::vector<Race> races;
+	for(auto &kv : byClass){
+		Race r;
+		r.cls = kv.first;
+		r.instances = kv.second;
+		for(int i=static_cast<int>(r.instances.size())-1; i>0; --i)
+			std::swap(r.instances[i], r.instances[rng.below(static_cast<uint32_t>(i + 1))]);
+		if(to.perClass > 0 && static_cast<int>(r.instances.size()) > to.perClass) r.instances.resize(to.perClass);
+		InstanceParams ip;
+		r.n = parseInstanceParams(instanceNameFromPath(r.instances[0]).c_str(), ip) ? ip.n : 0;
+		for(int j=0; j<static_cast<int>(cand.size()); ++j) r.alive.push_back(j);
+		r.cost.resize(cand.size());
+		r.eliminatedAt.assign(cand.size(), -1);
+		r.done = static_cast<long long>(r.alive.size()) > to.budget;
+		races.push_back(std::move(r));
+	}
+	int nThreads = resolveThreadCount(to.threads);
+	fprintf(stderr,"%zu classes, %zu candidates, %d threads\n", races.size(), cand.size(), nThreads);
+
+	FILE *log = NULL;
+	if(to.logPath != nullptr){
+		log = openOutput(to.logPath);
+		fprintf(log, "classe,bloco,instancia,semente,candidata,lucro,tempo_ms,custo\n");
+	}
+
+	// Rodadas: o próximo bloco de cada classe que ainda corre, avaliado em paralelo
+	std::vector<Evaluation> evals;
+	std::vector<size_t> firstEval(races.size());
+	for(int round=1; ; ++round){
+		evals.clear();
+		for(size_t r=0; r<races.size(); ++r){
+			firstEval[r] = evals.size();
+			if(races[r].done) continue;
+			for(int j : races[r].alive){
+				Evaluation ev;
+				ev.race = static_cast<int>(r);
+				ev.candidate = j;
+				evals.push_back(ev);
+			}
+		}
+		if(evals.empty()) break;
+		std::vector<int> order(evals.size());
+		for(size_t e=0; e<evals.size(); ++e) order[e] = static_cast<int>(e);
+		std::stable_sort(order.begin(), order.end(), [&](int a, int b){ return races[evals[a].race].n > races[evals[b].race].n; });
+		runWorkStealing(order, nThreads, [&](int e, int){
+			Evaluation &ev = evals[e];
+			const Race &r = races[ev.race];
+			ev.ok = evaluate(to, cand[ev.candidate], blockInstance(r, r.blocks), blockSeed(to, r.blocks), ev.profit, ev.ms);
+		});
+		int running = 0;
+		for(size_t r=0; r<races.size(); ++r){
+			if(races[r].done) continue;
+			size_t last = (r + 1 < races.size()) ? firstEval[r + 1] : evals.size();
+			closeBlock(to, known, races[r], evals, firstEval[r], last, log);
+			if(!races[r].done) ++running;
+		}
+		if(log != NULL) fflush(log);
+		fprintf(stderr,"round %d: %zu evaluations, %d classes still racing\n", round, evals.size(), running);
+	}
+	if(log != NULL) fclose(log);
+
+	// Perfil: a vencedora de cada classe
+	ParamProfile profile;
+	for(const Race &r : races){
+		int w = raceWinner(to, r);
+		ProfileEntry &e = profile.byClass[r.cls];
+		e.params = cand[w];
+		e.blocks = r.blocks;
+		e.meanCost = meanOf(r.cost[w], r.blocks);
+		size_t defaultBlocks = r.cost[0].size(); // a padrão até sair (ou todos os blocos)
+		fprintf(stderr,"%s: %d blocks, %lld evaluations, %zu alive; winner %d (mean cost %.6f", r.cls.c_str(), r.blocks,
+		        r.evaluations, r.alive.size(), w, e.meanCost);
+		if(w != 0)
+			fprintf(stderr,"; default %.6f vs %.6f over its %zu blocks%s", meanOf(r.cost[0], defaultBlocks), meanOf(r.cost[w], defaultBlocks),
+			        defaultBlocks, r.eliminatedAt[0] >= 0 ? ", eliminated" : "");
+		fprintf(stderr,")\n");
+	}
+	char comments[512];
+	snprintf(comments, sizeof(comments), "knapsack_tune: solver %s, time-limit-ms %lld, ms-weight %g, candidates %zu, budget %lld, test %s, confidence %g, seed %u\n"
+	         "custo = gap_otimo_pct + ms-weight * tempo_total_ms; use com --time-limit-ms %lld", to.solver, to.timeLimitMs, to.msWeight,
+	         cand.size(), to.budget, to.friedman ? "friedman" : "t", to.confidence, to.seed, to.timeLimitMs);
+	FILE *out = openOutput(to.outPath);
+	bool ok = profile.write(out, comments);
+	ok = (fclose(out) == 0) && ok;
+	if(!ok){
+		fprintf(stderr,"\nFail to Write File!! (%s)\n", to.outPath);
+		return 1;
+	}
+	fprintf(stderr,"profile written to %s\n", to.outPath);
+	return 0;
+}